@@ -0,0 +1,182 @@
+#include "Benchmark.h"
+#include "SessionCapture.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#if JUCE_LINUX
+#include <unistd.h>
+#elif JUCE_MAC
+#include <mach/mach.h>
+#endif
+
+namespace bench {
+
+void Results::add(const juce::String &suite, const juce::String &name,
+                  juce::DynamicObject::Ptr values) {
+  values->setProperty("suite", suite);
+  values->setProperty("name", name);
+  entries.add(juce::var(values.get()));
+}
+
+juce::var Results::toVar() const {
+  auto root = std::make_unique<juce::DynamicObject>();
+  root->setProperty("benchmark", "frogify");
+  root->setProperty("version", ProjectInfo::versionString);
+  root->setProperty("results", juce::var(entries));
+  return juce::var(root.release());
+}
+
+Stats Stats::fromSamples(const std::vector<double> &samples) {
+  Stats stats;
+  if (samples.empty()) {
+    return stats;
+  }
+  stats.min = *std::min_element(samples.begin(), samples.end());
+  stats.max = *std::max_element(samples.begin(), samples.end());
+  stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+               static_cast<double>(samples.size());
+  return stats;
+}
+
+void Stats::addTo(juce::DynamicObject &object,
+                  const juce::String &prefix) const {
+  object.setProperty(prefix + "_min", min);
+  object.setProperty(prefix + "_mean", mean);
+  object.setProperty(prefix + "_max", max);
+}
+
+int getIntOption(const juce::ArgumentList &args, const juce::String &option,
+                 int defaultValue) {
+  if (!args.containsOption(option)) {
+    return defaultValue;
+  }
+  return args.getValueForOption(option).getIntValue();
+}
+
+std::vector<double> getNumberListOption(const juce::ArgumentList &args,
+                                        const juce::String &option,
+                                        std::vector<double> defaultValues) {
+  if (!args.containsOption(option)) {
+    return defaultValues;
+  }
+  juce::StringArray tokens;
+  tokens.addTokens(args.getValueForOption(option), ",", {});
+  tokens.removeEmptyStrings();
+
+  std::vector<double> values;
+  for (const auto &token : tokens) {
+    values.push_back(token.getDoubleValue());
+  }
+  return values;
+}
+
+juce::int64 getResidentMemoryBytes() {
+#if JUCE_LINUX
+  // statm holds sizes in pages, the second field is the resident set
+  const auto statm = juce::File("/proc/self/statm").loadFileAsString();
+  juce::StringArray fields;
+  fields.addTokens(statm, " ", {});
+  if (fields.size() < 2) {
+    return -1;
+  }
+  return fields[1].getLargeIntValue() *
+         static_cast<juce::int64>(sysconf(_SC_PAGESIZE));
+#elif JUCE_MAC
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+    return -1;
+  }
+  return static_cast<juce::int64>(info.resident_size);
+#else
+  return -1;
+#endif
+}
+
+} // namespace bench
+
+namespace {
+
+struct Suite {
+  const char *name;
+  const char *description;
+  void (*run)(const juce::ArgumentList &, bench::Results &);
+};
+
+const Suite suites[] = {
+    {"state", "State save and load for many instances [--instances N]",
+     bench::runStateBenchmark},
+    {"dsp",
+     "Throughput of the shaper, each band, the chain and processBlock "
+     "[--block-sizes, --channels, --sample-rates, --frogginess, --frames, "
+     "--perf]",
+     bench::runDspBenchmark},
+    {"instances",
+     "Many instances processed round robin, with memory per instance "
+     "[--instance-counts, --block-size, --blocks, --sample-rate]",
+     bench::runInstancesBenchmark},
+    {"startup",
+     "Construct, prepareToPlay, editor, release and destroy timed separately, "
+     "plus a host scan [--startup-iterations, --no-editor]",
+     bench::runStartupBenchmark},
+    {"parameters",
+     "Parameter pipeline under load from a message and an audio thread "
+     "[--parameters, --rate, --state-interval-ms, --duration-ms]",
+     bench::runParameterBenchmark},
+    {"replay",
+     "A session recorded with FROGIFY_CAPTURE replayed through the processor "
+     "[--capture file, --iterations]",
+     bench::runReplayBenchmark},
+};
+
+void printUsage() {
+  std::cout << "Usage: frogify_bench [--suite name[,name...]] "
+               "[--output results.json] [suite options]\n\nSuites:\n";
+  for (const auto &suite : suites) {
+    std::cout << "  " << suite.name << ": " << suite.description << "\n";
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  if (args.containsOption("--help|-h")) {
+    printUsage();
+    return 0;
+  }
+
+  // The processor owns an APVTS, which needs a message manager
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  // FROGIFY_CAPTURE set for a host session must not record the tool itself
+  SessionCapture::setEnvironmentCaptureAllowed(false);
+
+  juce::StringArray selected;
+  if (args.containsOption("--suite")) {
+    selected.addTokens(args.getValueForOption("--suite"), ",", {});
+  }
+
+  bench::Results results;
+  for (const auto &suite : suites) {
+    if (selected.isEmpty() || selected.contains(suite.name)) {
+      std::cerr << "Running suite: " << suite.name << std::endl;
+      suite.run(args, results);
+    }
+  }
+
+  const auto json = juce::JSON::toString(results.toVar());
+  if (args.containsOption("--output")) {
+    const juce::File outputFile{args.getValueForOption("--output")};
+    if (!outputFile.replaceWithText(json)) {
+      std::cerr << "Could not write " << outputFile.getFullPathName()
+                << std::endl;
+      return 1;
+    }
+  } else {
+    std::cout << json << std::endl;
+  }
+  return 0;
+}
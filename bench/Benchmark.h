@@ -0,0 +1,60 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <chrono>
+#include <vector>
+
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+// Collects the results of all suites, every measurement is one JSON object
+class Results {
+public:
+  void add(const juce::String &suite, const juce::String &name,
+           juce::DynamicObject::Ptr values);
+  juce::var toVar() const;
+
+private:
+  juce::Array<juce::var> entries;
+};
+
+// Summary of repeated timing measurements
+struct Stats {
+  double min = 0.0;
+  double mean = 0.0;
+  double max = 0.0;
+
+  static Stats fromSamples(const std::vector<double> &samples);
+  void addTo(juce::DynamicObject &object, const juce::String &prefix) const;
+};
+
+// Runs fn once and returns the elapsed wall clock time in milliseconds
+template <typename Fn> double measureMilliseconds(Fn &&fn) {
+  const auto start = Clock::now();
+  fn();
+  const auto end = Clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Integer command line option with a default value
+int getIntOption(const juce::ArgumentList &args, const juce::String &option,
+                 int defaultValue);
+
+// Comma separated list of numbers, e.g. --block-sizes 16,256,8192
+std::vector<double> getNumberListOption(const juce::ArgumentList &args,
+                                        const juce::String &option,
+                                        std::vector<double> defaultValues);
+
+// Resident set size of the whole process, -1 if unknown on this platform
+juce::int64 getResidentMemoryBytes();
+
+// Suites, each one lives in its own translation unit
+void runStateBenchmark(const juce::ArgumentList &args, Results &results);
+void runDspBenchmark(const juce::ArgumentList &args, Results &results);
+void runInstancesBenchmark(const juce::ArgumentList &args, Results &results);
+void runStartupBenchmark(const juce::ArgumentList &args, Results &results);
+void runParameterBenchmark(const juce::ArgumentList &args, Results &results);
+void runReplayBenchmark(const juce::ArgumentList &args, Results &results);
+
+} // namespace bench
@@ -0,0 +1,255 @@
+#include "Benchmark.h"
+#include "PerfCounters.h"
+#include "PluginProcessor.h"
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+struct Config {
+  int blockSize;
+  int numChannels;
+  double sampleRate;
+  float frogginess;
+};
+
+// Timing of one kernel, plus hardware counters per sample when available
+struct Measurement {
+  Stats nsPerSample;
+  bool hasCounters = false;
+  PerfCounters::Values countersPerSample{};
+};
+
+// Processes blocks of one configuration and times them. The input is copied
+// into the work buffer before every block, like a host handing over fresh
+// audio, so repeated processing never runs away. The "copy" unit measures
+// that overhead on its own. Hardware counters, if given, are read around
+// every timed pass.
+class Runner {
+public:
+  Runner(const Config &c, int frames, int iters, PerfCounters *perfCounters)
+      : config(c), numBlocks(juce::jmax(1, frames / c.blockSize)),
+        iterations(iters), counters(perfCounters),
+        input(c.numChannels, c.blockSize),
+        work(c.numChannels, c.blockSize) {
+    juce::Random random(7);
+    for (int ch = 0; ch < input.getNumChannels(); ++ch) {
+      auto *samples = input.getWritePointer(ch);
+      for (int i = 0; i < input.getNumSamples(); ++i) {
+        samples[i] = random.nextFloat() - 0.5f;
+      }
+    }
+  }
+
+  // Per sample figures, one sample being one frame of one channel
+  template <typename Fn> Measurement measure(Fn &&process) {
+    runBlocks(process);
+
+    const double samplesPerPass = static_cast<double>(numBlocks) *
+                                  config.blockSize * config.numChannels;
+    Measurement measurement;
+    measurement.hasCounters = counters != nullptr;
+
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; ++i) {
+      if (counters != nullptr) {
+        counters->start();
+      }
+      const auto ms = measureMilliseconds([&] { runBlocks(process); });
+      if (counters != nullptr) {
+        counters->stop();
+        const auto values = counters->read();
+        for (size_t c = 0; c < values.size(); ++c) {
+          auto &perSample = measurement.countersPerSample[c];
+          if (values[c] < 0.0 || perSample < 0.0) {
+            perSample = -1.0;
+          } else {
+            perSample += values[c] / (samplesPerPass * iterations);
+          }
+        }
+      }
+      samples.push_back(ms * 1.0e6 / samplesPerPass);
+    }
+    measurement.nsPerSample = Stats::fromSamples(samples);
+    return measurement;
+  }
+
+  // Processes the whole buffer in place with a juce::dsp processor
+  template <typename Processor> Measurement measureDsp(Processor &processor) {
+    return measure([&processor](juce::AudioBuffer<float> &buffer) {
+      juce::dsp::AudioBlock<float> block(buffer);
+      processor.process(juce::dsp::ProcessContextReplacing<float>(block));
+    });
+  }
+
+private:
+  template <typename Fn> void runBlocks(Fn &process) {
+    juce::ScopedNoDenormals noDenormals;
+    for (int b = 0; b < numBlocks; ++b) {
+      for (int ch = 0; ch < config.numChannels; ++ch) {
+        work.copyFrom(ch, 0, input, ch, 0, config.blockSize);
+      }
+      process(work);
+    }
+  }
+
+  Config config;
+  int numBlocks;
+  int iterations;
+  PerfCounters *counters;
+  juce::AudioBuffer<float> input;
+  juce::AudioBuffer<float> work;
+};
+
+void addResult(Results &results, const juce::String &unit,
+               const Config &config, const Measurement &measurement) {
+  const auto &stats = measurement.nsPerSample;
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("block_size", config.blockSize);
+  values->setProperty("channels", config.numChannels);
+  values->setProperty("sample_rate", config.sampleRate);
+  values->setProperty("frogginess", config.frogginess);
+  stats.addTo(*values, "ns_per_sample");
+  values->setProperty("samples_per_sec",
+                      stats.mean > 0.0 ? 1.0e9 / stats.mean : 0.0);
+
+  if (measurement.hasCounters) {
+    const auto &perSample = measurement.countersPerSample;
+    for (size_t c = 0; c < perSample.size(); ++c) {
+      if (perSample[c] >= 0.0) {
+        values->setProperty(juce::String(PerfCounters::Names[c]) +
+                                "_per_sample",
+                            perSample[c]);
+      }
+    }
+    const auto cycles = perSample[PerfCounters::Cycles];
+    const auto instructions = perSample[PerfCounters::Instructions];
+    if (cycles > 0.0 && instructions >= 0.0) {
+      values->setProperty("ipc", instructions / cycles);
+    }
+  }
+  results.add("dsp", unit, values);
+}
+
+juce::dsp::ProcessSpec makeSpec(const Config &config) {
+  return {config.sampleRate, static_cast<juce::uint32>(config.blockSize),
+          static_cast<juce::uint32>(config.numChannels)};
+}
+
+// The processor only supports mono and stereo main buses
+bool prepareProcessor(DynamicsAudioProcessor &processor,
+                      const Config &config) {
+  if (config.numChannels > 2) {
+    return false;
+  }
+  const auto channelSet = config.numChannels == 1
+                              ? juce::AudioChannelSet::mono()
+                              : juce::AudioChannelSet::stereo();
+  auto layout = processor.getBusesLayout();
+  layout.getChannelSet(true, 0) = channelSet;
+  layout.getChannelSet(false, Bus::Main) = channelSet;
+  if (!processor.setBusesLayout(layout)) {
+    return false;
+  }
+
+  auto &manager = processor.getParameterManager();
+  manager.getParameter(Param::Enabled)->setValueNotifyingHost(1.0f);
+  manager.getParameter(Param::MorphEnabled)->setValueNotifyingHost(0.0f);
+  auto *frogginess = manager.getParameter(Param::FroginessLevel);
+  frogginess->setValueNotifyingHost(
+      frogginess->convertTo0to1(config.frogginess * 100.0f));
+
+  processor.prepareToPlay(config.sampleRate, config.blockSize);
+  return true;
+}
+
+void runConfig(const Config &config, int frames, int iterations,
+               PerfCounters *counters, Results &results) {
+  Runner runner(config, frames, iterations, counters);
+  const auto spec = makeSpec(config);
+
+  addResult(results, "copy", config,
+            runner.measure([](juce::AudioBuffer<float> &) {}));
+
+  FrogWaveShaper shaper;
+  shaper.frogginess = config.frogginess;
+  addResult(results, "shaper", config, runner.measureDsp(shaper));
+
+  FormantTable::Bands coefficients;
+  FormantTable::getShared(config.sampleRate)
+      ->lookup(config.frogginess, coefficients);
+
+  for (size_t i = 0; i < FormantTable::NumBands; ++i) {
+    FormantBand band;
+    band.prepare(spec);
+    band.setCoefficients(coefficients[i]);
+    const auto name = "band" + juce::String(static_cast<int>(i) + 1);
+    addResult(results, name, config, runner.measureDsp(band));
+  }
+
+  DynamicsAudioProcessor::Chain chain;
+  chain.prepare(spec);
+  chain.get<0>().setCoefficients(coefficients[0]);
+  chain.get<1>().setCoefficients(coefficients[1]);
+  chain.get<2>().setCoefficients(coefficients[2]);
+  chain.get<3>().frogginess = config.frogginess;
+  addResult(results, "chain", config, runner.measureDsp(chain));
+
+  DynamicsAudioProcessor processor;
+  if (prepareProcessor(processor, config)) {
+    juce::MidiBuffer midi;
+    addResult(results, "process_block", config,
+              runner.measure([&processor, &midi](
+                                 juce::AudioBuffer<float> &buffer) {
+                processor.processBlock(buffer, midi);
+              }));
+    processor.releaseResources();
+  }
+}
+
+} // namespace
+
+void runDspBenchmark(const juce::ArgumentList &args, Results &results) {
+  const auto blockSizes = getNumberListOption(args, "--block-sizes",
+                                              {16, 64, 256, 1024, 8192});
+  const auto channelCounts =
+      getNumberListOption(args, "--channels", {1, 2, 8, 16});
+  const auto sampleRates =
+      getNumberListOption(args, "--sample-rates", {44100, 48000, 96000});
+  const auto frogginessLevels =
+      getNumberListOption(args, "--frogginess", {0.0, 0.5, 1.0});
+  const auto frames = juce::jmax(1, getIntOption(args, "--frames", 1 << 16));
+  const auto iterations = juce::jmax(1, getIntOption(args, "--iterations", 3));
+
+  // Counters follow the calling thread, which runs every kernel
+  std::unique_ptr<PerfCounters> counters;
+  if (args.containsOption("--perf")) {
+    counters = std::make_unique<PerfCounters>();
+    if (!counters->isAvailable()) {
+      std::cerr << "Hardware counters are not available, reporting timing "
+                   "only"
+                << std::endl;
+      counters.reset();
+    }
+  }
+
+  for (auto blockSize : blockSizes) {
+    for (auto numChannels : channelCounts) {
+      for (auto sampleRate : sampleRates) {
+        for (auto frogginess : frogginessLevels) {
+          const Config config{
+              juce::jmax(1, static_cast<int>(blockSize)),
+              juce::jmax(1, static_cast<int>(numChannels)), sampleRate,
+              juce::jlimit(0.0f, 1.0f, static_cast<float>(frogginess))};
+          runConfig(config, frames, iterations, counters.get(), results);
+        }
+      }
+    }
+  }
+}
+
+} // namespace bench
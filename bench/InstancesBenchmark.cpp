@@ -0,0 +1,175 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+
+#include <memory>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+// One processor with its own buffer, like a node in a host graph
+struct Instance {
+  std::unique_ptr<DynamicsAudioProcessor> processor;
+  juce::AudioBuffer<float> buffer;
+};
+
+void addFootprint(Results &results) {
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("processor",
+                      static_cast<int>(sizeof(DynamicsAudioProcessor)));
+  values->setProperty("parameter_manager",
+                      static_cast<int>(sizeof(mrta::ParameterManager)));
+  values->setProperty(
+      "apvts", static_cast<int>(sizeof(juce::AudioProcessorValueTreeState)));
+  values->setProperty("chain",
+                      static_cast<int>(sizeof(DynamicsAudioProcessor::Chain)));
+  values->setProperty("morph_engine", static_cast<int>(sizeof(MorphEngine)));
+  values->setProperty("telemetry", static_cast<int>(sizeof(BlockTelemetry)));
+  values->setProperty("stage_profiler",
+                      static_cast<int>(sizeof(StageProfiler)));
+  values->setProperty("formant_table", static_cast<int>(sizeof(FormantTable)));
+  results.add("instances", "sizeof", values);
+}
+
+// What the processors' own block telemetry saw during the run, summed over
+// every instance. Bucket i counts blocks which took between i/16 and
+// (i + 1)/16 of their deadline.
+void addDeadlineHistogram(std::vector<Instance> &instances, int numInstances,
+                          int blockSize, Results &results) {
+  BlockTelemetry::Histogram histogram{};
+  uint64_t numBlocks = 0;
+  uint64_t numOverruns = 0;
+  uint64_t numDroppedOverruns = 0;
+  float maxDeadlineFraction = 0.0f;
+  std::vector<BlockTelemetry::Overrun> overruns;
+  for (auto &instance : instances) {
+    auto &telemetry = instance.processor->getTelemetry();
+    const auto instanceHistogram = telemetry.getHistogram();
+    for (size_t i = 0; i < histogram.size(); ++i) {
+      histogram[i] += instanceHistogram[i];
+    }
+    numBlocks += telemetry.getNumBlocks();
+    numOverruns += telemetry.getNumOverruns();
+    numDroppedOverruns += telemetry.getNumDroppedOverruns();
+    maxDeadlineFraction =
+        juce::jmax(maxDeadlineFraction, telemetry.getMaxDeadlineFraction());
+    telemetry.drainOverruns(overruns);
+  }
+
+  juce::Array<juce::var> buckets;
+  for (const auto count : histogram) {
+    buckets.add(static_cast<juce::int64>(count));
+  }
+
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("instances", numInstances);
+  values->setProperty("block_size", blockSize);
+  values->setProperty("blocks", static_cast<juce::int64>(numBlocks));
+  values->setProperty("buckets_per_deadline",
+                      BlockTelemetry::BucketsPerDeadline);
+  values->setProperty("histogram", buckets);
+  values->setProperty("max_deadline_fraction", maxDeadlineFraction);
+  values->setProperty("overruns", static_cast<juce::int64>(numOverruns));
+  values->setProperty("overruns_drained",
+                      static_cast<int>(overruns.size()));
+  values->setProperty("overruns_dropped",
+                      static_cast<juce::int64>(numDroppedOverruns));
+  results.add("instances", "deadline_histogram", values);
+}
+
+void runInstances(int numInstances, double sampleRate, int blockSize,
+                  int numBlocks, Results &results) {
+  juce::Random random(42);
+  std::vector<Instance> instances(static_cast<size_t>(numInstances));
+
+  // Resident memory is only a delta of the whole process, so it includes
+  // allocator overhead and may reuse memory freed by an earlier run
+  const auto rssBefore = getResidentMemoryBytes();
+  for (auto &instance : instances) {
+    instance.processor = std::make_unique<DynamicsAudioProcessor>();
+  }
+  const auto rssConstructed = getResidentMemoryBytes();
+
+  for (auto &instance : instances) {
+    auto &processor = *instance.processor;
+    for (auto *param : processor.getParameters()) {
+      param->setValueNotifyingHost(random.nextFloat());
+    }
+    auto &manager = processor.getParameterManager();
+    manager.getParameter(Param::Enabled)->setValueNotifyingHost(1.0f);
+
+    processor.prepareToPlay(sampleRate, blockSize);
+    instance.buffer.setSize(processor.getTotalNumOutputChannels(), blockSize);
+    for (int ch = 0; ch < instance.buffer.getNumChannels(); ++ch) {
+      auto *samples = instance.buffer.getWritePointer(ch);
+      for (int i = 0; i < blockSize; ++i) {
+        samples[i] = (random.nextFloat() - 0.5f) * 0.5f;
+      }
+    }
+  }
+  const auto rssPrepared = getResidentMemoryBytes();
+
+  // Round robin, every instance processes its block before the next block
+  // starts. Each entry is the time of one whole graph pass.
+  juce::MidiBuffer midi;
+  std::vector<double> blockTimes;
+  blockTimes.reserve(static_cast<size_t>(numBlocks));
+  for (int block = 0; block < numBlocks; ++block) {
+    blockTimes.push_back(measureMilliseconds([&] {
+      for (auto &instance : instances) {
+        instance.processor->processBlock(instance.buffer, midi);
+      }
+    }));
+  }
+
+  const auto stats = Stats::fromSamples(blockTimes);
+  const double deadlineMs = 1000.0 * blockSize / sampleRate;
+  const double perInstanceUs = stats.mean * 1000.0 / numInstances;
+
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("instances", numInstances);
+  values->setProperty("block_size", blockSize);
+  values->setProperty("sample_rate", sampleRate);
+  stats.addTo(*values, "ms_per_block");
+  values->setProperty("us_per_instance_block", perInstanceUs);
+  values->setProperty("deadline_fraction", stats.mean / deadlineMs);
+  values->setProperty("samples_per_sec",
+                      stats.mean > 0.0 ? 1000.0 * blockSize * numInstances /
+                                             stats.mean
+                                       : 0.0);
+  if (rssBefore >= 0 && rssConstructed >= 0 && rssPrepared >= 0) {
+    values->setProperty("rss_bytes_per_instance_constructed",
+                        static_cast<double>(rssConstructed - rssBefore) /
+                            numInstances);
+    values->setProperty("rss_bytes_per_instance_prepared",
+                        static_cast<double>(rssPrepared - rssBefore) /
+                            numInstances);
+  }
+  results.add("instances", "round_robin", values);
+
+  addDeadlineHistogram(instances, numInstances, blockSize, results);
+
+  for (auto &instance : instances) {
+    instance.processor->releaseResources();
+  }
+}
+
+} // namespace
+
+void runInstancesBenchmark(const juce::ArgumentList &args, Results &results) {
+  const auto instanceCounts = getNumberListOption(
+      args, "--instance-counts", {1, 10, 50, 100, 200, 300});
+  const auto blockSize = juce::jmax(1, getIntOption(args, "--block-size", 256));
+  const auto numBlocks = juce::jmax(1, getIntOption(args, "--blocks", 200));
+  const auto sampleRate =
+      static_cast<double>(getIntOption(args, "--sample-rate", 48000));
+
+  addFootprint(results);
+  for (auto count : instanceCounts) {
+    runInstances(juce::jmax(1, static_cast<int>(count)), sampleRate,
+                 blockSize, numBlocks, results);
+  }
+}
+
+} // namespace bench
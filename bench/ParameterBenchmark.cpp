@@ -0,0 +1,261 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+// Bare processor owning a ParameterManager with N float parameters, so the
+// harness can register its own callbacks and see every delivered change
+class HarnessProcessor : public juce::AudioProcessor {
+public:
+  explicit HarnessProcessor(int numParameters)
+      : manager(*this, "ParameterHarness", makeInfos(numParameters)) {}
+
+  mrta::ParameterManager manager;
+
+  const juce::String getName() const override { return "ParameterHarness"; }
+  void prepareToPlay(double, int) override {}
+  void releaseResources() override {}
+  void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override {}
+  double getTailLengthSeconds() const override { return 0.0; }
+  bool acceptsMidi() const override { return false; }
+  bool producesMidi() const override { return false; }
+  juce::AudioProcessorEditor *createEditor() override { return nullptr; }
+  bool hasEditor() const override { return false; }
+  int getNumPrograms() override { return 1; }
+  int getCurrentProgram() override { return 0; }
+  void setCurrentProgram(int) override {}
+  const juce::String getProgramName(int) override { return {}; }
+  void changeProgramName(int, const juce::String &) override {}
+  void getStateInformation(juce::MemoryBlock &destData) override {
+    manager.getStateInformation(destData);
+  }
+  void setStateInformation(const void *data, int sizeInBytes) override {
+    manager.setStateInformation(data, sizeInBytes);
+  }
+
+private:
+  static std::vector<mrta::ParameterInfo> makeInfos(int numParameters) {
+    std::vector<mrta::ParameterInfo> infos;
+    for (int i = 0; i < numParameters; ++i) {
+      infos.emplace_back("param" + juce::String(i), "Param " + juce::String(i),
+                         "", 0.0f, 0.0f, 1.0f, 0.0001f, 1.0f);
+    }
+    return infos;
+  }
+};
+
+int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch())
+      .count();
+}
+
+// Age of the oldest change of every parameter not yet seen by a callback.
+// The message thread stamps a parameter when it changes it, the audio thread
+// takes the stamp when the callback fires. With coalescing this is the
+// latency of the first change of each batch, i.e. the worst case.
+class LatencyTracker {
+public:
+  LatencyTracker(size_t numParameters, size_t capacity)
+      : pendingSince(std::make_unique<std::atomic<int64_t>[]>(numParameters)) {
+    latenciesNs.reserve(capacity);
+  }
+
+  // Message thread
+  void markChanged(size_t index) {
+    int64_t expected = 0;
+    pendingSince[index].compare_exchange_strong(expected, nowNs());
+  }
+
+  // Audio thread, never grows the preallocated storage
+  void markDelivered(size_t index) {
+    const auto since = pendingSince[index].exchange(0);
+    if (since > 0 && latenciesNs.size() < latenciesNs.capacity()) {
+      latenciesNs.push_back(static_cast<double>(nowNs() - since));
+    }
+  }
+
+  std::vector<double> &getLatencies() { return latenciesNs; }
+
+private:
+  std::unique_ptr<std::atomic<int64_t>[]> pendingSince;
+  std::vector<double> latenciesNs;
+};
+
+double percentile(std::vector<double> samples, double fraction) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  std::sort(samples.begin(), samples.end());
+  const auto index = static_cast<size_t>(fraction * (samples.size() - 1));
+  return samples[index];
+}
+
+void addDistribution(juce::DynamicObject &object, const juce::String &prefix,
+                     const std::vector<double> &samplesNs) {
+  std::vector<double> samplesUs(samplesNs.size());
+  std::transform(samplesNs.begin(), samplesNs.end(), samplesUs.begin(),
+                 [](double ns) { return ns / 1000.0; });
+  Stats::fromSamples(samplesUs).addTo(object, prefix);
+  object.setProperty(prefix + "_p50", percentile(samplesUs, 0.5));
+  object.setProperty(prefix + "_p99", percentile(samplesUs, 0.99));
+}
+
+} // namespace
+
+void runParameterBenchmark(const juce::ArgumentList &args, Results &results) {
+  // The manager queue holds up to 64 parameters
+  const auto numParameters =
+      juce::jlimit(1, 64, getIntOption(args, "--parameters", 64));
+  const auto rateHz = juce::jmax(1, getIntOption(args, "--rate", 5000));
+  const auto stateIntervalMs =
+      juce::jmax(1, getIntOption(args, "--state-interval-ms", 100));
+  const auto durationMs =
+      juce::jmax(1, getIntOption(args, "--duration-ms", 2000));
+  const auto blockSize = juce::jmax(1, getIntOption(args, "--block-size", 64));
+  const auto sampleRate =
+      static_cast<double>(getIntOption(args, "--sample-rate", 48000));
+
+  HarnessProcessor processor(numParameters);
+  auto &manager = processor.manager;
+
+  const auto blockPeriod = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(blockSize / sampleRate));
+  const auto maxBlocks = static_cast<size_t>(
+      durationMs / 1000.0 * sampleRate / blockSize * 2.0 + 16.0);
+
+  const auto maxLatencies =
+      static_cast<size_t>(rateHz) * durationMs / 1000 +
+      static_cast<size_t>(durationMs / stateIntervalMs + 1) * numParameters +
+      1024;
+  LatencyTracker latency(static_cast<size_t>(numParameters), maxLatencies);
+  std::atomic<uint64_t> numCallbacks{0};
+  for (int i = 0; i < numParameters; ++i) {
+    const auto index = static_cast<size_t>(i);
+    auto callback = [&latency, &numCallbacks, index](float, bool) {
+      latency.markDelivered(index);
+      numCallbacks.fetch_add(1, std::memory_order_relaxed);
+    };
+    manager.registerParameterCallback(static_cast<uint32_t>(i), callback);
+  }
+  manager.updateParameters(true);
+
+  // Two random states, loaded in turn now and then, so every load changes
+  // every parameter
+  std::array<juce::MemoryBlock, 2> bulkStates;
+  {
+    juce::Random random(7);
+    for (auto &state : bulkStates) {
+      for (int i = 0; i < numParameters; ++i) {
+        manager.getParameter(static_cast<uint32_t>(i))
+            ->setValueNotifyingHost(random.nextFloat());
+      }
+      manager.getStateInformation(state);
+    }
+    for (int i = 0; i < numParameters; ++i) {
+      manager.getParameter(static_cast<uint32_t>(i))
+          ->setValueNotifyingHost(0.0f);
+    }
+    manager.updateParameters(true);
+  }
+
+  std::atomic<bool> running{true};
+  std::vector<double> updateNs;
+  updateNs.reserve(maxBlocks);
+  uint64_t numLateBlocks = 0;
+
+  std::thread audioThread([&] {
+    auto next = Clock::now();
+    while (running.load()) {
+      const auto start = Clock::now();
+      manager.updateParameters();
+      const auto end = Clock::now();
+      if (updateNs.size() < updateNs.capacity()) {
+        updateNs.push_back(
+            std::chrono::duration<double, std::nano>(end - start).count());
+      }
+
+      next += blockPeriod;
+      if (end > next) {
+        ++numLateBlocks;
+        next = end;
+      }
+      std::this_thread::sleep_until(next);
+    }
+  });
+
+  uint64_t numEventsSent = 0;
+  uint64_t numStateLoads = 0;
+  std::thread messageThread([&] {
+    juce::Random random(42);
+    const auto eventPeriod = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / rateHz));
+    const auto statePeriod = std::chrono::milliseconds(stateIntervalMs);
+    auto nextEvent = Clock::now();
+    auto nextState = nextEvent + statePeriod;
+
+    while (running.load()) {
+      if (Clock::now() >= nextState) {
+        for (int i = 0; i < numParameters; ++i) {
+          latency.markChanged(static_cast<size_t>(i));
+        }
+        const auto &state = bulkStates[numStateLoads % bulkStates.size()];
+        processor.setStateInformation(state.getData(),
+                                      static_cast<int>(state.getSize()));
+        ++numStateLoads;
+        nextState += statePeriod;
+      }
+
+      // Always move the parameter, an unchanged value would not notify
+      const auto index = random.nextInt(numParameters);
+      auto *param = manager.getParameter(static_cast<uint32_t>(index));
+      const auto value =
+          std::fmod(param->getValue() + 0.1f + 0.8f * random.nextFloat(), 1.0f);
+      latency.markChanged(static_cast<size_t>(index));
+      param->setValueNotifyingHost(value);
+      ++numEventsSent;
+
+      nextEvent += eventPeriod;
+      std::this_thread::sleep_until(nextEvent);
+    }
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+  running.store(false);
+  messageThread.join();
+  audioThread.join();
+
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("parameters", numParameters);
+  values->setProperty("rate_hz", rateHz);
+  values->setProperty("state_interval_ms", stateIntervalMs);
+  values->setProperty("block_size", blockSize);
+  values->setProperty("sample_rate", sampleRate);
+  values->setProperty("duration_ms", durationMs);
+  values->setProperty("events_sent", static_cast<juce::int64>(numEventsSent));
+  values->setProperty("state_loads", static_cast<juce::int64>(numStateLoads));
+  values->setProperty("callbacks",
+                      static_cast<juce::int64>(numCallbacks.load()));
+  values->setProperty(
+      "coalesced",
+      static_cast<juce::int64>(manager.getNumCoalescedParameterEvents()));
+  values->setProperty(
+      "dropped",
+      static_cast<juce::int64>(manager.getNumDroppedParameterEvents()));
+  values->setProperty("blocks", static_cast<juce::int64>(updateNs.size()));
+  values->setProperty("late_blocks", static_cast<juce::int64>(numLateBlocks));
+  addDistribution(*values, "latency_us", latency.getLatencies());
+  addDistribution(*values, "update_us", updateNs);
+  results.add("parameters", "pipeline", values);
+}
+
+} // namespace bench
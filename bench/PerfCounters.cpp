@@ -0,0 +1,127 @@
+#include "PerfCounters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace bench {
+
+#if defined(__linux__)
+
+namespace {
+
+struct EventConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr uint64_t cacheReadMiss(uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+constexpr std::array<EventConfig, PerfCounters::NumCounters> eventConfigs{{
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cacheReadMiss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cacheReadMiss(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+}};
+
+int openCounter(const EventConfig &event) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // Calling thread only, on any CPU
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+  for (size_t i = 0; i < fds.size(); ++i) {
+    fds[i] = openCounter(eventConfigs[i]);
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (auto fd : fds) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+void PerfCounters::start() noexcept {
+  for (auto fd : fds) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+void PerfCounters::stop() noexcept {
+  for (auto fd : fds) {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+}
+
+PerfCounters::Values PerfCounters::read() const noexcept {
+  Values values;
+  for (size_t i = 0; i < fds.size(); ++i) {
+    values[i] = -1.0;
+    // value, time enabled, time running
+    uint64_t data[3] = {};
+    if (fds[i] < 0 || ::read(fds[i], data, sizeof(data)) != sizeof(data)) {
+      continue;
+    }
+    // More events than hardware counters are multiplexed, scale the count
+    // up to the whole enabled time
+    values[i] = data[2] > 0 ? static_cast<double>(data[0]) *
+                                  static_cast<double>(data[1]) /
+                                  static_cast<double>(data[2])
+                            : 0.0;
+  }
+  return values;
+}
+
+#else
+
+PerfCounters::PerfCounters() { fds.fill(-1); }
+PerfCounters::~PerfCounters() = default;
+void PerfCounters::start() noexcept {}
+void PerfCounters::stop() noexcept {}
+
+PerfCounters::Values PerfCounters::read() const noexcept {
+  Values values;
+  values.fill(-1.0);
+  return values;
+}
+
+#endif
+
+bool PerfCounters::isAvailable() const noexcept {
+  for (auto fd : fds) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace bench
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace bench {
+
+// Hardware performance counters read around a measured section, through
+// perf_event_open on Linux. Counters the kernel refuses (permissions,
+// virtual machines, missing PMU) are skipped individually. When none can
+// be opened, or on other platforms, isAvailable() is false and benchmarks
+// report timing only.
+class PerfCounters {
+public:
+  enum Counter {
+    Cycles = 0,
+    Instructions,
+    L1DMisses,
+    LLCMisses,
+    BranchMisses,
+    NumCounters
+  };
+
+  static constexpr std::array<const char *, NumCounters> Names{
+      "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+  // Counts since the last start(), scaled for multiplexing. A negative value
+  // means the counter is not available.
+  using Values = std::array<double, NumCounters>;
+
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  bool isAvailable() const noexcept;
+  bool isOpen(Counter counter) const noexcept { return fds[counter] >= 0; }
+
+  // Resets and enables all open counters
+  void start() noexcept;
+  // Disables all open counters
+  void stop() noexcept;
+  Values read() const noexcept;
+
+private:
+  std::array<int, NumCounters> fds;
+};
+
+} // namespace bench
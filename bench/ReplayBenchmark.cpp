@@ -0,0 +1,56 @@
+#include "Benchmark.h"
+#include "SessionReplay.h"
+
+#include <iostream>
+#include <vector>
+
+namespace bench {
+
+void runReplayBenchmark(const juce::ArgumentList &args, Results &results) {
+  if (!args.containsOption("--capture")) {
+    std::cerr << "No --capture given, skipping" << std::endl;
+    return;
+  }
+
+  const auto captureFile = args.getFileForOption("--capture");
+  const SessionReplay replay(captureFile);
+  if (!replay.isValid()) {
+    std::cerr << replay.getError() << std::endl;
+    return;
+  }
+
+  const auto iterations = juce::jmax(1, getIntOption(args, "--iterations", 3));
+  std::vector<double> blockUs;
+  std::vector<double> realtimeFactors;
+  blockUs.reserve(static_cast<size_t>(replay.getNumBlocks()) *
+                  static_cast<size_t>(iterations));
+
+  for (int i = 0; i < iterations; ++i) {
+    DynamicsAudioProcessor processor;
+    double totalNs = 0.0;
+    replay.run(processor,
+               [&blockUs, &totalNs](int, const juce::AudioBuffer<float> &,
+                                    double ns) {
+                 blockUs.push_back(ns / 1000.0);
+                 totalNs += ns;
+               });
+    processor.releaseResources();
+    if (totalNs > 0.0) {
+      realtimeFactors.push_back(replay.getDurationSeconds() * 1.0e9 /
+                                totalNs);
+    }
+  }
+
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("capture", captureFile.getFileName());
+  values->setProperty("blocks", replay.getNumBlocks());
+  values->setProperty("gaps", replay.getNumGaps());
+  values->setProperty("duration_s", replay.getDurationSeconds());
+  values->setProperty("sample_rate", replay.getSampleRate());
+  values->setProperty("channels", replay.getNumChannels());
+  Stats::fromSamples(blockUs).addTo(*values, "block_us");
+  Stats::fromSamples(realtimeFactors).addTo(*values, "realtime_factor");
+  results.add("replay", captureFile.getFileNameWithoutExtension(), values);
+}
+
+} // namespace bench
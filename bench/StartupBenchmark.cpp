@@ -0,0 +1,84 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+
+#include <memory>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+void addResult(Results &results, const juce::String &name,
+               const std::vector<double> &samples) {
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("iterations", static_cast<int>(samples.size()));
+  Stats::fromSamples(samples).addTo(*values, "us");
+  results.add("startup", name, values);
+}
+
+double toMicroseconds(double milliseconds) { return milliseconds * 1000.0; }
+
+// What a host scan does: construct, read the parameter list and the
+// default state, destroy. No prepareToPlay.
+double measureScan() {
+  return toMicroseconds(measureMilliseconds([] {
+    auto processor = std::make_unique<DynamicsAudioProcessor>();
+    for (auto *param : processor->getParameters()) {
+      juce::ignoreUnused(param->getName(64), param->getDefaultValue());
+    }
+    juce::MemoryBlock state;
+    processor->getStateInformation(state);
+    processor.reset();
+  }));
+}
+
+} // namespace
+
+void runStartupBenchmark(const juce::ArgumentList &args, Results &results) {
+  const auto iterations =
+      juce::jmax(1, getIntOption(args, "--startup-iterations", 200));
+  const auto sampleRate =
+      static_cast<double>(getIntOption(args, "--sample-rate", 48000));
+  const auto blockSize = juce::jmax(1, getIntOption(args, "--block-size", 512));
+  const bool withEditor = !args.containsOption("--no-editor");
+
+  std::vector<double> construct, prepare, createEditor, destroyEditor,
+      release, destroy, scan;
+
+  for (int i = 0; i < iterations; ++i) {
+    std::unique_ptr<DynamicsAudioProcessor> processor;
+    construct.push_back(toMicroseconds(measureMilliseconds(
+        [&] { processor = std::make_unique<DynamicsAudioProcessor>(); })));
+
+    prepare.push_back(toMicroseconds(measureMilliseconds(
+        [&] { processor->prepareToPlay(sampleRate, blockSize); })));
+
+    // The editor has to go before the processor it refers to
+    if (withEditor) {
+      std::unique_ptr<juce::AudioProcessorEditor> editor;
+      createEditor.push_back(toMicroseconds(measureMilliseconds(
+          [&] { editor.reset(processor->createEditorIfNeeded()); })));
+      destroyEditor.push_back(
+          toMicroseconds(measureMilliseconds([&] { editor.reset(); })));
+    }
+
+    release.push_back(toMicroseconds(
+        measureMilliseconds([&] { processor->releaseResources(); })));
+    destroy.push_back(
+        toMicroseconds(measureMilliseconds([&] { processor.reset(); })));
+
+    scan.push_back(measureScan());
+  }
+
+  addResult(results, "construct", construct);
+  addResult(results, "prepare_to_play", prepare);
+  if (withEditor) {
+    addResult(results, "create_editor", createEditor);
+    addResult(results, "destroy_editor", destroyEditor);
+  }
+  addResult(results, "release_resources", release);
+  addResult(results, "destroy", destroy);
+  addResult(results, "scan", scan);
+}
+
+} // namespace bench
@@ -0,0 +1,133 @@
+#include "Benchmark.h"
+#include "PluginProcessor.h"
+
+#include <memory>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+using Processors = std::vector<std::unique_ptr<DynamicsAudioProcessor>>;
+
+void randomiseParameters(DynamicsAudioProcessor &processor,
+                         juce::Random &random) {
+  for (auto *param : processor.getParameters()) {
+    param->setValueNotifyingHost(random.nextFloat());
+  }
+}
+
+// Moves every parameter away from the saved state, so the next load has to
+// set each of them again instead of skipping unchanged values
+void randomiseAll(const Processors &processors, juce::Random &random) {
+  for (auto &p : processors) {
+    randomiseParameters(*p, random);
+  }
+}
+
+// Touches one parameter per instance, so the next save has to serialise
+void dirtyState(const Processors &processors, juce::Random &random) {
+  for (auto &p : processors) {
+    p->getParameters().getFirst()->setValueNotifyingHost(random.nextFloat());
+  }
+}
+
+// Runs one save or load pass over all instances per iteration, beforePass
+// runs untimed ahead of every pass
+template <typename Fn, typename BeforePass>
+Stats measurePasses(const Processors &processors, int iterations, Fn &&fn,
+                    BeforePass &&beforePass) {
+  std::vector<double> samples;
+  for (int i = 0; i < iterations; ++i) {
+    beforePass();
+    samples.push_back(measureMilliseconds([&] {
+      for (size_t p = 0; p < processors.size(); ++p) {
+        fn(*processors[p], p);
+      }
+    }));
+  }
+  return Stats::fromSamples(samples);
+}
+
+template <typename Fn>
+Stats measurePasses(const Processors &processors, int iterations, Fn &&fn) {
+  return measurePasses(processors, iterations, std::forward<Fn>(fn), [] {});
+}
+
+void addResult(Results &results, const juce::String &name, const Stats &stats,
+               size_t numInstances, size_t bytesPerInstance) {
+  auto values = juce::DynamicObject::Ptr(new juce::DynamicObject());
+  values->setProperty("instances", static_cast<int>(numInstances));
+  values->setProperty("bytes_per_instance", static_cast<int>(bytesPerInstance));
+  stats.addTo(*values, "ms");
+  values->setProperty("us_per_instance",
+                      stats.mean * 1000.0 / static_cast<double>(numInstances));
+  results.add("state", name, values);
+}
+
+} // namespace
+
+void runStateBenchmark(const juce::ArgumentList &args, Results &results) {
+  const auto numInstances =
+      static_cast<size_t>(juce::jmax(1, getIntOption(args, "--instances", 500)));
+  const auto iterations = juce::jmax(1, getIntOption(args, "--iterations", 5));
+
+  juce::Random random(42);
+  Processors processors;
+  for (size_t i = 0; i < numInstances; ++i) {
+    processors.push_back(std::make_unique<DynamicsAudioProcessor>());
+    randomiseParameters(*processors.back(), random);
+  }
+
+  std::vector<juce::MemoryBlock> blobs(numInstances);
+
+  // Binary format, as written and read by the processor. Unchanged state is
+  // served from the cache, so dirty and clean saves are measured separately
+  auto saveBinary = measurePasses(
+      processors, iterations,
+      [&blobs](DynamicsAudioProcessor &p, size_t i) {
+        p.getStateInformation(blobs[i]);
+      },
+      [&] { dirtyState(processors, random); });
+  addResult(results, "save_binary", saveBinary, numInstances,
+            blobs.front().getSize());
+
+  auto saveBinaryCached = measurePasses(
+      processors, iterations, [&blobs](DynamicsAudioProcessor &p, size_t i) {
+        p.getStateInformation(blobs[i]);
+      });
+  addResult(results, "save_binary_cached", saveBinaryCached, numInstances,
+            blobs.front().getSize());
+
+  auto loadBinary = measurePasses(
+      processors, iterations,
+      [&blobs](DynamicsAudioProcessor &p, size_t i) {
+        p.setStateInformation(blobs[i].getData(),
+                              static_cast<int>(blobs[i].getSize()));
+      },
+      [&] { randomiseAll(processors, random); });
+  addResult(results, "load_binary", loadBinary, numInstances,
+            blobs.front().getSize());
+
+  // APVTS value tree format, used by older sessions
+  auto saveValueTree = measurePasses(
+      processors, iterations, [&blobs](DynamicsAudioProcessor &p, size_t i) {
+        blobs[i].reset();
+        juce::MemoryOutputStream mos(blobs[i], false);
+        p.getParameterManager().getAPVTS().state.writeToStream(mos);
+      });
+  addResult(results, "save_valuetree", saveValueTree, numInstances,
+            blobs.front().getSize());
+
+  auto loadValueTree = measurePasses(
+      processors, iterations,
+      [&blobs](DynamicsAudioProcessor &p, size_t i) {
+        p.setStateInformation(blobs[i].getData(),
+                              static_cast<int>(blobs[i].getSize()));
+      },
+      [&] { randomiseAll(processors, random); });
+  addResult(results, "load_valuetree", loadValueTree, numInstances,
+            blobs.front().getSize());
+}
+
+} // namespace bench
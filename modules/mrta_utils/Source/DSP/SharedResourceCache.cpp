@@ -0,0 +1,28 @@
+namespace mrta
+{
+
+SharedResourceCache& SharedResourceCache::getInstance()
+{
+    // Constructed on first use, so it costs nothing at library load
+    static SharedResourceCache instance;
+    return instance;
+}
+
+size_t SharedResourceCache::getNumResources() const
+{
+    const std::lock_guard<std::mutex> lock { mutex };
+    return static_cast<size_t>(std::count_if(entries.begin(), entries.end(), [] (const auto& e) { return !e.second.expired(); }));
+}
+
+void SharedResourceCache::removeExpired()
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.expired())
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <typeindex>
+
+namespace mrta
+{
+
+// Process wide cache of immutable DSP resources (lookup tables,
+// coefficient grids, FFT plans...) shared by all plugin instances.
+// Resources are keyed by type, sample rate and quality, built once on
+// the first request and released when the last user drops its reference.
+// Requests lock a mutex and may build a resource, so they must be done
+// off the audio thread, e.g. in prepareToPlay.
+class SharedResourceCache
+{
+public:
+    // Get the process wide cache
+    static SharedResourceCache& getInstance();
+
+    // Get the resource for the given sample rate and quality, calling
+    // factory(sampleRate, quality) to build it if nobody holds it yet
+    // The factory must return something convertible to std::shared_ptr<const Resource>
+    template<typename Resource, typename Factory>
+    std::shared_ptr<const Resource> get(double sampleRate, int quality, Factory&& factory)
+    {
+        const Key key { std::type_index(typeid(Resource)), sampleRate, quality };
+        const std::lock_guard<std::mutex> lock { mutex };
+
+        auto it = entries.find(key);
+        if (it != entries.end())
+            if (auto existing = it->second.lock())
+                return std::static_pointer_cast<const Resource>(existing);
+
+        std::shared_ptr<const Resource> created { factory(sampleRate, quality) };
+        entries[key] = created;
+        removeExpired();
+        return created;
+    }
+
+    // Number of resources currently alive in the cache
+    size_t getNumResources() const;
+
+private:
+    SharedResourceCache() = default;
+
+    struct Key
+    {
+        std::type_index type;
+        double sampleRate;
+        int quality;
+
+        bool operator<(const Key& other) const
+        {
+            return std::tie(type, sampleRate, quality) < std::tie(other.type, other.sampleRate, other.quality);
+        }
+    };
+
+    void removeExpired();
+
+    mutable std::mutex mutex;
+    std::map<Key, std::weak_ptr<const void>> entries;
+
+    JUCE_DECLARE_NON_COPYABLE(SharedResourceCache)
+    JUCE_DECLARE_NON_MOVEABLE(SharedResourceCache)
+};
+
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+namespace mrta
+{
+
+// Coalescing parameter change queue.
+// Every parameter owns a slot with its latest value and a dirty flag,
+// a parameter index is only queued when its slot turns dirty, so
+// the consumer sees at most one event per parameter between pops and
+// always reads the most recent value. Since an index can only be
+// queued once, the queue never overflows as long as the number of
+// parameters stays within MaxParameters.
+template<size_t MaxParameters>
+class ParameterChangeQueue
+{
+public:
+    explicit ParameterChangeQueue(size_t _numParameters) :
+        numParameters { _numParameters },
+        slots { std::make_unique<Slot[]>(_numParameters) }
+    {
+        static_assert(MaxParameters > 0, "MaxParameters should be at least 1.");
+        jassert(numParameters <= MaxParameters);
+    }
+
+    // Empty the queue and mark all slots as clean
+    void clear()
+    {
+        fifo.clear();
+        for (size_t i = 0; i < numParameters; ++i)
+            slots[i].dirty.store(false);
+    }
+
+    // Store a new value for a parameter, the index is queued only if
+    // there is no pending change for the parameter already. Out of range
+    // indices are counted as dropped, in release builds too.
+    void pushParameter(uint32_t index, float newValue)
+    {
+        if (index >= numParameters)
+        {
+            jassertfalse;
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Slot& slot { slots[index] };
+        slot.value.store(newValue, std::memory_order_relaxed);
+
+        if (slot.dirty.exchange(true))
+        {
+            numCoalesced.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (!fifo.pushParameter(index, newValue))
+        {
+            slot.dirty.store(false);
+            numDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Pop the next changed parameter with its latest value,
+    // returns false if there are no pending changes
+    bool popParameter(mrta::ParameterEvent& event)
+    {
+        auto next = fifo.popParameter();
+        if (!next.first)
+            return false;
+
+        // Only pushParameter fills the fifo and it rejects bad indices
+        jassert(next.second.index < numParameters);
+
+        // Clear the flag before reading the value, a change that lands
+        // in between queues the index again instead of being lost
+        Slot& slot { slots[next.second.index] };
+        slot.dirty.exchange(false);
+
+        event = next.second;
+        event.value = slot.value.load(std::memory_order_relaxed);
+        return true;
+    }
+
+    // Number of changes merged into an already pending change
+    uint64_t getNumCoalescedEvents() const
+    {
+        return numCoalesced.load(std::memory_order_relaxed);
+    }
+
+    // Number of changes that could not be queued at all
+    uint64_t getNumDroppedEvents() const
+    {
+        return numDropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<float> value { 0.f };
+        std::atomic<bool> dirty { false };
+    };
+
+    const size_t numParameters;
+    std::unique_ptr<Slot[]> slots;
+
+    // AbstractFifo keeps one element free, so one extra element
+    // is needed to fit an event for every parameter
+    mrta::ParameterFIFO<MaxParameters + 1> fifo;
+
+    std::atomic<uint64_t> numCoalesced { 0 };
+    std::atomic<uint64_t> numDropped { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterChangeQueue)
+    JUCE_DECLARE_NON_MOVEABLE(ParameterChangeQueue)
+    JUCE_LEAK_DETECTOR(ParameterChangeQueue)
+};
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string_view>
+
+namespace mrta
+{
+
+// Compile time description of a parameter
+// Unlike ParameterInfo it holds no juce::String, so tables of
+// descriptors are constant initialised and cost nothing at library
+// load, ParameterInfo objects are created from them per instance
+struct ParameterDescriptor
+{
+    // Float ctor
+    constexpr ParameterDescriptor(std::string_view _ID, std::string_view _name, std::string_view _unit,
+                                  float _def, float _min, float _max,
+                                  float _inc, float _skw) :
+        ID { _ID }, name { _name }, unit { _unit },
+        type { ParameterInfo::Float },
+        def { _def }, min { _min }, max { _max },
+        inc { _inc }, skw { _skw }
+    { }
+
+    // Choice ctor, steps must point to storage with static duration
+    constexpr ParameterDescriptor(std::string_view _ID, std::string_view _name,
+                                  const std::string_view* _steps, size_t _numSteps, unsigned int _def) :
+        ID { _ID }, name { _name },
+        steps { _steps }, numSteps { _numSteps },
+        type { ParameterInfo::Choice },
+        def { static_cast<float>(_def) }, min { 0.f }, max { static_cast<float>(_numSteps - 1) },
+        inc { 1.f }, skw { 1.f }
+    { }
+
+    // Bool ctor
+    constexpr ParameterDescriptor(std::string_view _ID, std::string_view _name,
+                                  std::string_view offStepName, std::string_view onStepName,
+                                  bool _def) :
+        ID { _ID }, name { _name },
+        boolSteps { offStepName, onStepName },
+        type { ParameterInfo::Bool },
+        def { _def ? 1.f : 0.f }, min { 0.f }, max { 1.f },
+        inc { 1.f }, skw { 1.f }
+    { }
+
+    std::string_view ID;
+    std::string_view name;
+    std::string_view unit { };
+    const std::string_view* steps { nullptr };
+    size_t numSteps { 0 };
+    std::string_view boolSteps[2] { };
+
+    ParameterInfo::Type type;
+
+    float def;
+    float min;
+    float max;
+    float inc;
+    float skw;
+};
+
+// Index of a parameter ID in a descriptor table, usable in constant
+// expressions, returns the table size if the ID is not found
+template<size_t N>
+constexpr uint32_t findParameterIndex(const std::array<ParameterDescriptor, N>& descriptors, std::string_view ID)
+{
+    for (size_t i = 0; i < N; ++i)
+        if (descriptors[i].ID == ID)
+            return static_cast<uint32_t>(i);
+    return static_cast<uint32_t>(N);
+}
+
+// Create the runtime parameter information from a descriptor
+inline ParameterInfo makeParameterInfo(const ParameterDescriptor& d)
+{
+    auto toString = [] (std::string_view s) { return juce::String::fromUTF8(s.data(), static_cast<int>(s.size())); };
+
+    switch (d.type)
+    {
+        case ParameterInfo::Choice:
+        {
+            juce::StringArray steps;
+            for (size_t i = 0; i < d.numSteps; ++i)
+                steps.add(toString(d.steps[i]));
+            return { toString(d.ID), toString(d.name), steps, static_cast<unsigned int>(d.def) };
+        }
+
+        case ParameterInfo::Bool:
+            return { toString(d.ID), toString(d.name), toString(d.boolSteps[0]), toString(d.boolSteps[1]), d.def > 0.5f };
+
+        case ParameterInfo::Float:
+        default:
+            return { toString(d.ID), toString(d.name), toString(d.unit), d.def, d.min, d.max, d.inc, d.skw };
+    }
+}
+
+// Create the runtime parameter information for a whole descriptor table
+template<size_t N>
+std::vector<ParameterInfo> makeParameterInfos(const std::array<ParameterDescriptor, N>& descriptors)
+{
+    std::vector<ParameterInfo> infos;
+    infos.reserve(N);
+    for (const auto& d : descriptors)
+        infos.push_back(makeParameterInfo(d));
+    return infos;
+}
+
+}
@@ -3,6 +3,16 @@
 namespace mrta
 {
 
+// Single parameter change event, the parameter is identified by its
+// index in the ParameterManager parameters vector so the payload is
+// trivially copyable and never touches the heap
+struct ParameterEvent
+{
+    uint32_t index { 0 };
+    float value { 0.f };
+    uint32_t sampleOffset { 0 };
+};
+
 template<size_t Capacity>
 class ParameterFIFO
 {
@@ -18,7 +28,7 @@ public:
         abstractFIFO.reset();
     }
 
-    bool pushParameter(const juce::String& parameterID, float newValue)
+    bool pushParameter(uint32_t index, float newValue, uint32_t sampleOffset = 0)
     {
         if (abstractFIFO.getFreeSpace() == 0)
             return false;
@@ -26,15 +36,15 @@ public:
         auto scope = abstractFIFO.write(1);
 
         if (scope.blockSize1 > 0)
-            buffer[scope.startIndex1] = std::make_pair(parameterID, newValue);
+            buffer[scope.startIndex1] = { index, newValue, sampleOffset };
 
         if (scope.blockSize2 > 0)
-            buffer[scope.startIndex2] = std::make_pair(parameterID, newValue);
+            buffer[scope.startIndex2] = { index, newValue, sampleOffset };
 
         return true;
     }
 
-    std::pair<bool, std::pair<juce::String, float>> popParameter()
+    std::pair<bool, ParameterEvent> popParameter()
     {
         if (abstractFIFO.getNumReady() == 0)
             return {};
@@ -45,14 +55,16 @@ public:
             return { true, buffer[scope.startIndex1] };
 
         if (scope.blockSize2 > 0)
-            return {true, buffer[scope.startIndex2] };
+            return { true, buffer[scope.startIndex2] };
 
-        return { false, { "", 0.f } };
+        return { false, { } };
     }
 
 private:
+    static_assert(std::is_trivially_copyable<ParameterEvent>::value, "Events must be trivially copyable.");
+
     juce::AbstractFifo abstractFIFO;
-    std::array<std::pair<juce::String, float>, Capacity> buffer;
+    std::array<ParameterEvent, Capacity> buffer;
 
     JUCE_DECLARE_NON_COPYABLE(ParameterFIFO)
     JUCE_DECLARE_NON_MOVEABLE(ParameterFIFO)
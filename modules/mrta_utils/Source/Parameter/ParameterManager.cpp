@@ -1,6 +1,53 @@
 namespace mrta
 {
 
+namespace
+{
+    // Binary state layout, all fields are little endian
+    // Header: magic, version, number of entries (uint32 each)
+    // Entries: parameter ID hash (uint32), value (float32)
+    // Version 1 keyed entries by parameter index (uint16) instead,
+    // which breaks as soon as a parameter is inserted in the table
+    constexpr uint32_t stateMagic { 0x5354524d }; // "MRTS"
+    constexpr size_t stateHeaderSize { 3 * sizeof(uint32_t) };
+    constexpr size_t stateEntrySize { sizeof(uint32_t) + sizeof(float) };
+    constexpr size_t stateEntrySizeV1 { sizeof(uint16_t) + sizeof(float) };
+
+    // 32 bit FNV-1a of the parameter ID, stable across builds and
+    // independent of where the parameter sits in the table
+    uint32_t hashParameterID(const juce::String& ID)
+    {
+        uint32_t hash { 2166136261u };
+        for (auto* c { ID.toRawUTF8() }; *c != 0; ++c)
+        {
+            hash ^= static_cast<uint8_t>(*c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void writeUInt32(uint8_t* dst, uint32_t value)
+    {
+        value = juce::ByteOrder::swapIfBigEndian(value);
+        std::memcpy(dst, &value, sizeof(value));
+    }
+
+    void writeFloat(uint8_t* dst, float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        writeUInt32(dst, bits);
+    }
+
+    float readFloat(const uint8_t* src)
+    {
+        const uint32_t bits { juce::ByteOrder::littleEndianInt(src) };
+        float value { 0.f };
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout(const std::vector<mrta::ParameterInfo>& infos)
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
@@ -51,55 +98,113 @@ juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout(const
 
 ParameterManager::ParameterManager(juce::AudioProcessor& audioProcessor, const juce::String& identifier, const std::vector<mrta::ParameterInfo>& _parameters) :
     apvts(audioProcessor, nullptr, identifier, createParameterLayout(_parameters)),
-    parameters { _parameters }
+    parameters { _parameters },
+    parameterObjects(_parameters.size(), nullptr),
+    queue { _parameters.size() },
+    callbacks(_parameters.size()),
+    rawValues(_parameters.size(), nullptr),
+    idHashes(_parameters.size(), 0)
 {
+    jassert(parameters.size() <= std::numeric_limits<uint16_t>::max());
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        parameterObjects[i] = apvts.getParameter(parameters[i].ID);
+        rawValues[i] = apvts.getRawParameterValue(parameters[i].ID);
+        idHashes[i] = hashParameterID(parameters[i].ID);
+
+        // Two IDs sharing a hash could not be told apart in the state
+        jassert(std::find(idHashes.begin(), idHashes.begin() + static_cast<std::ptrdiff_t>(i), idHashes[i])
+                == idHashes.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+
+    // Every parameter is listened to, so state changes are tracked
+    // even for parameters without a callback
+    listeners.reserve(parameters.size());
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        listeners.push_back(std::make_unique<ParameterListener>(*this, static_cast<uint32_t>(i)));
+        apvts.addParameterListener(parameters[i].ID, listeners.back().get());
+    }
+
+    registeredIndices.reserve(parameters.size());
 }
 
 ParameterManager::~ParameterManager()
 {
-    for (const auto& c : callbacks)
-        apvts.removeParameterListener(c.first, this);
+    for (const auto& l : listeners)
+        apvts.removeParameterListener(parameters[l->index].ID, l.get());
 }
 
 bool ParameterManager::registerParameterCallback(const juce::String& ID, Callback cb)
 {
-    if (ID.isNotEmpty() && cb)
+    const int index { getParameterIndex(ID) };
+    if (index >= 0)
+        return registerParameterCallback(static_cast<uint32_t>(index), std::move(cb));
+    return false;
+}
+
+bool ParameterManager::registerParameterCallback(uint32_t index, Callback cb)
+{
+    if (index < callbacks.size() && cb && !callbacks[index])
     {
-        if (callbacks.find(ID) == callbacks.end())
-        {
-            apvts.addParameterListener(ID, this);
-            callbacks[ID] = cb;
-            return true;
-        }
+        callbacks[index] = std::move(cb);
+        registeredIndices.push_back(index);
+        return true;
     }
     return false;
 }
 
 void ParameterManager::updateParameters(bool force)
+{
+    updateParameters(force, EventObserver {});
+}
+
+void ParameterManager::updateParameters(bool force, const EventObserver& observer)
 {
     if (force)
     {
-        std::for_each(callbacks.begin(), callbacks.end(), [this] (auto& p)
-        {
-            if (auto* raw { apvts.getRawParameterValue(p.first) })
-                p.second(raw->load(), true);
-        });
-        fifo.clear();
+        for (const uint32_t i : registeredIndices)
+            if (auto* raw { rawValues[i] })
+                callbacks[i](raw->load(), true);
+        queue.clear();
     }
 
-    auto newParam = fifo.popParameter();
-    while (newParam.first)
+    mrta::ParameterEvent event;
+    while (queue.popParameter(event))
     {
-        auto it = callbacks.find(newParam.second.first);
-        if (it != callbacks.end())
-            it->second(newParam.second.second, false);
-        newParam = fifo.popParameter();
+        // An index outside the table is a bug upstream, skip the event
+        // rather than read past the callbacks in a release build
+        if (event.index >= callbacks.size())
+        {
+            jassertfalse;
+            continue;
+        }
+
+        if (observer)
+            observer(event.index, event.value);
+
+        if (callbacks[event.index])
+        {
+            MRTA_TRACE_SCOPE("Parameter callback", "parameters");
+            callbacks[event.index](event.value, false);
+        }
     }
 }
 
 void ParameterManager::clearParameterQueue()
 {
-    fifo.clear();
+    queue.clear();
+}
+
+uint64_t ParameterManager::getNumCoalescedParameterEvents() const
+{
+    return queue.getNumCoalescedEvents();
+}
+
+uint64_t ParameterManager::getNumDroppedParameterEvents() const
+{
+    return queue.getNumDroppedEvents();
 }
 
 const std::vector<mrta::ParameterInfo>& ParameterManager::getParameters() const
@@ -107,6 +212,17 @@ const std::vector<mrta::ParameterInfo>& ParameterManager::getParameters() const
     return parameters;
 }
 
+int ParameterManager::getParameterIndex(const juce::String& ID) const
+{
+    auto it = std::find_if(parameters.begin(), parameters.end(), [&ID] (const mrta::ParameterInfo& p) { return p.ID == ID; });
+    return it != parameters.end() ? static_cast<int>(std::distance(parameters.begin(), it)) : -1;
+}
+
+juce::RangedAudioParameter* ParameterManager::getParameter(uint32_t index) const
+{
+    return index < parameterObjects.size() ? parameterObjects[index] : nullptr;
+}
+
 juce::AudioProcessorValueTreeState& ParameterManager::getAPVTS()
 {
     return apvts;
@@ -114,19 +230,129 @@ juce::AudioProcessorValueTreeState& ParameterManager::getAPVTS()
 
 void ParameterManager::setStateInformation(const void* data, int sizeInBytes)
 {
-    juce::ValueTree newState { juce::ValueTree::readFromData(data, sizeInBytes) };
-    apvts.replaceState(newState);
+    MRTA_TRACE_SCOPE("Load state", "state");
+
+    if (data == nullptr || sizeInBytes <= 0)
+        return;
+
+    const auto* bytes { static_cast<const uint8_t*>(data) };
+    const size_t size { static_cast<size_t>(sizeInBytes) };
+    if (size >= stateHeaderSize && juce::ByteOrder::littleEndianInt(bytes) == stateMagic)
+    {
+        setBinaryState(bytes, size);
+        return;
+    }
+
+    // Sessions saved before the binary format contain the APVTS value tree
+    juce::ValueTree newState { juce::ValueTree::readFromData(data, size) };
+    if (newState.isValid())
+        apvts.replaceState(newState);
 }
 
 void ParameterManager::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::MemoryOutputStream mos(destData, false);
-    apvts.state.writeToStream(mos);
+    MRTA_TRACE_SCOPE("Save state", "state");
+
+    const juce::ScopedLock lock { stateLock };
+
+    // A change landing while writing bumps the generation again,
+    // so the next call serialises the state once more
+    const uint32_t generation { stateGeneration.load() };
+    if (generation != cachedStateGeneration)
+    {
+        writeBinaryState(cachedState);
+        cachedStateGeneration = generation;
+    }
+
+    destData.replaceAll(cachedState.getData(), cachedState.getSize());
+}
+
+uint32_t ParameterManager::getStateGeneration() const
+{
+    return stateGeneration.load();
+}
+
+void ParameterManager::parameterChanged(uint32_t index, float newValue)
+{
+    MRTA_TRACE_SCOPE("Parameter changed", "parameters");
+    stateGeneration.fetch_add(1);
+    queue.pushParameter(index, newValue);
 }
 
-void ParameterManager::parameterChanged(const juce::String& parameterID, float newValue)
+void ParameterManager::writeBinaryState(juce::MemoryBlock& destData) const
 {
-    fifo.pushParameter(parameterID, newValue);
+    const size_t numEntries { parameters.size() };
+    destData.setSize(stateHeaderSize + numEntries * stateEntrySize);
+
+    auto* data { static_cast<uint8_t*>(destData.getData()) };
+    writeUInt32(data, stateMagic);
+    writeUInt32(data + 4, StateVersion);
+    writeUInt32(data + 8, static_cast<uint32_t>(numEntries));
+
+    uint8_t* entry { data + stateHeaderSize };
+    for (size_t i = 0; i < numEntries; ++i, entry += stateEntrySize)
+    {
+        writeUInt32(entry, idHashes[i]);
+        writeFloat(entry + sizeof(uint32_t), rawValues[i] != nullptr ? rawValues[i]->load() : parameters[i].def);
+    }
+}
+
+bool ParameterManager::setBinaryState(const uint8_t* data, size_t size)
+{
+    const uint32_t version { juce::ByteOrder::littleEndianInt(data + 4) };
+    const uint32_t numEntries { juce::ByteOrder::littleEndianInt(data + 8) };
+
+    // State saved by a newer version, or truncated
+    if (version == 0 || version > StateVersion)
+        return false;
+    const size_t entrySize { version == 1 ? stateEntrySizeV1 : stateEntrySize };
+    if (numEntries > (size - stateHeaderSize) / entrySize)
+        return false;
+
+    // Parameters the blob does not mention go back to their defaults,
+    // a loaded state never inherits values from the previous one
+    std::vector<float> values(parameters.size());
+    for (size_t i = 0; i < parameters.size(); ++i)
+        values[i] = parameters[i].def;
+
+    const uint8_t* entry { data + stateHeaderSize };
+    for (uint32_t e = 0; e < numEntries; ++e, entry += entrySize)
+    {
+        size_t index { parameters.size() };
+        float value { 0.f };
+        if (version == 1)
+        {
+            index = juce::ByteOrder::littleEndianShort(entry);
+            value = readFloat(entry + sizeof(uint16_t));
+        }
+        else
+        {
+            const uint32_t hash { juce::ByteOrder::littleEndianInt(entry) };
+            const auto it { std::find(idHashes.begin(), idHashes.end(), hash) };
+            index = static_cast<size_t>(std::distance(idHashes.begin(), it));
+            value = readFloat(entry + sizeof(uint32_t));
+        }
+
+        // Unknown parameters and garbage values are skipped
+        if (index >= parameters.size() || !std::isfinite(value))
+            continue;
+
+        const mrta::ParameterInfo& info { parameters[index] };
+        values[index] = juce::jlimit(info.min, info.max, value);
+    }
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        juce::RangedAudioParameter* param { parameterObjects[i] };
+        if (param == nullptr)
+            continue;
+
+        const float normalised { param->convertTo0to1(values[i]) };
+        if (param->getValue() != normalised)
+            param->setValueNotifyingHost(normalised);
+    }
+
+    return true;
 }
 
 }
@@ -3,11 +3,12 @@
 namespace mrta
 {
 
-class ParameterManager : public juce::AudioProcessorValueTreeState::Listener
+class ParameterManager
 {
 public:
-    // Callback function type alias
-    using Callback = std::function<void(float value, bool forced)>;
+    // Callback function type alias, callables are stored inline
+    // so registering and calling them never allocates
+    using Callback = mrta::FixedFunction<void(float value, bool forced)>;
 
     // Main ctor
     ParameterManager(juce::AudioProcessor& audioProcessor,
@@ -25,6 +26,10 @@ public:
     // to avoid missing parameter events
     bool registerParameterCallback(const juce::String& ID, Callback cb);
 
+    // Same as above, but using the parameter index on the
+    // parameters vector instead of the parameter ID
+    bool registerParameterCallback(uint32_t index, Callback cb);
+
     // Checks if there are parameter change events on the queue
     // and call the respective callbacks for them
     // This method is supposed to be calle on every process buffer
@@ -35,12 +40,34 @@ public:
     // good way to guarantee the DSP has updated parameters
     void updateParameters(bool force = false);
 
+    // Observer of the events updateParameters applies, stored inline
+    using EventObserver = mrta::FixedFunction<void(uint32_t index, float value)>;
+
+    // Same as above, and reports every queued event it pops to the
+    // observer, in order, including events for parameters without a
+    // callback. Values flushed by a forced update are not reported.
+    void updateParameters(bool force, const EventObserver& observer);
+
     // Empty the paramter event queue
     void clearParameterQueue();
 
+    // Diagnostics for the parameter event queue, the number of
+    // events merged into a pending change for the same parameter
+    // and the number of events that could not be queued at all
+    uint64_t getNumCoalescedParameterEvents() const;
+    uint64_t getNumDroppedParameterEvents() const;
+
     // Get a vector with all the parameters information structs
     const std::vector<mrta::ParameterInfo>& getParameters() const;
 
+    // Get the index of a parameter ID in the parameters vector,
+    // returns -1 if there is no parameter with that ID
+    int getParameterIndex(const juce::String& ID) const;
+
+    // Get the APVTS parameter object for a parameter index,
+    // returns nullptr if the index is out of range
+    juce::RangedAudioParameter* getParameter(uint32_t index) const;
+
     // Get underlying JUCE APVTS, can be useful for
     // using widgets to track parameters
     juce::AudioProcessorValueTreeState& getAPVTS();
@@ -48,22 +75,80 @@ public:
     // Helper functions for serialising the current parameter
     // state, has the same signature as juce::AudioProcessor
     // uses for parameter state load and save
+    // Loads both the binary format and the APVTS value tree
+    // format used by sessions saved with older versions
     void setStateInformation(const void* data, int sizeInBytes);
 
     // Helper functions for serialising the current parameter
     // state, has the same signature as juce::AudioProcessor
     // uses for parameter state load and save
+    // The state is written as a compact, versioned binary table
+    // of parameter ID hashes and values, parameters missing from
+    // a loaded state are reset to their defaults
+    // The last written state is cached, and only serialised again
+    // after a parameter has changed
     void getStateInformation(juce::MemoryBlock& destData);
 
-    // Parameter change listener, this function is not meant to
-    // be called by user, it is used by the APVTS listerners only
-    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    // Counter bumped on every parameter change, can be used
+    // to detect state changes without comparing values
+    uint32_t getStateGeneration() const;
+
+    // Version of the binary state format written by getStateInformation
+    static constexpr uint32_t StateVersion { 2 };
 
 private:
+    // Validates a binary state blob and writes its values directly
+    // to the parameters, returns false if the blob is not valid
+    bool setBinaryState(const uint8_t* data, size_t size);
+
+    // Serialises the current parameter values in the binary format
+    void writeBinaryState(juce::MemoryBlock& destData) const;
+
+    // Called by the listeners on every parameter change
+    void parameterChanged(uint32_t index, float newValue);
+
+    using Queue = mrta::ParameterChangeQueue<64>;
+
+    // APVTS listener for a single parameter, the parameter index
+    // is resolved once on construction so change events are handled
+    // without any string lookup or copy
+    class ParameterListener : public juce::AudioProcessorValueTreeState::Listener
+    {
+    public:
+        ParameterListener(ParameterManager& _manager, uint32_t _index) :
+            index { _index }, manager { _manager }
+        { }
+
+        void parameterChanged(const juce::String&, float newValue) override
+        {
+            manager.parameterChanged(index, newValue);
+        }
+
+        const uint32_t index;
+
+    private:
+        ParameterManager& manager;
+
+        JUCE_DECLARE_NON_COPYABLE(ParameterListener)
+    };
+
     juce::AudioProcessorValueTreeState apvts;
     std::vector<mrta::ParameterInfo> parameters;
-    mrta::ParameterFIFO<64> fifo;
-    std::unordered_map<juce::String, Callback> callbacks;
+    std::vector<juce::RangedAudioParameter*> parameterObjects;
+    Queue queue;
+    std::vector<std::unique_ptr<ParameterListener>> listeners;
+
+    // Flat tables indexed by parameter index
+    std::vector<Callback> callbacks;
+    std::vector<std::atomic<float>*> rawValues;
+    std::vector<uint32_t> registeredIndices;
+    std::vector<uint32_t> idHashes;
+
+    // State cache, rewritten when the generation moves on
+    std::atomic<uint32_t> stateGeneration { 1 };
+    uint32_t cachedStateGeneration { 0 };
+    juce::MemoryBlock cachedState;
+    juce::CriticalSection stateLock;
 
     JUCE_DECLARE_NON_COPYABLE(ParameterManager)
     JUCE_DECLARE_NON_MOVEABLE(ParameterManager)
@@ -0,0 +1,122 @@
+#pragma once
+
+namespace mrta
+{
+
+template<typename Signature, size_t Capacity = 32>
+class FixedFunction;
+
+// Fixed capacity replacement for std::function, the callable is stored
+// inline so construction, copy and invocation never touch the heap.
+// Callables bigger than Capacity bytes are rejected at compile time.
+template<typename Ret, typename... Args, size_t Capacity>
+class FixedFunction<Ret(Args...), Capacity>
+{
+public:
+    FixedFunction() noexcept = default;
+
+    FixedFunction(std::nullptr_t) noexcept { }
+
+    template<typename Fn, typename = std::enable_if_t<!std::is_same<std::decay_t<Fn>, FixedFunction>::value>>
+    FixedFunction(Fn&& fn)
+    {
+        using Stored = std::decay_t<Fn>;
+        static_assert(sizeof(Stored) <= Capacity, "Callable does not fit in the FixedFunction storage.");
+        static_assert(alignof(Stored) <= alignof(std::max_align_t), "Callable alignment is not supported.");
+
+        new (&storage) Stored(std::forward<Fn>(fn));
+        invoker = [] (void* s, Args... args) -> Ret
+        {
+            return (*static_cast<Stored*>(s))(std::forward<Args>(args)...);
+        };
+        manager = [] (Operation op, void* dst, void* src)
+        {
+            switch (op)
+            {
+                case Operation::Copy: new (dst) Stored(*static_cast<const Stored*>(src)); break;
+                case Operation::Move: new (dst) Stored(std::move(*static_cast<Stored*>(src))); break;
+                case Operation::Destroy: static_cast<Stored*>(dst)->~Stored(); break;
+            }
+        };
+    }
+
+    FixedFunction(const FixedFunction& other)
+    {
+        if (other.manager)
+            other.manager(Operation::Copy, &storage, const_cast<void*>(static_cast<const void*>(&other.storage)));
+        invoker = other.invoker;
+        manager = other.manager;
+    }
+
+    FixedFunction(FixedFunction&& other) noexcept
+    {
+        if (other.manager)
+            other.manager(Operation::Move, &storage, &other.storage);
+        invoker = other.invoker;
+        manager = other.manager;
+    }
+
+    FixedFunction& operator=(const FixedFunction& other)
+    {
+        if (this != &other)
+        {
+            FixedFunction copy { other };
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    FixedFunction& operator=(FixedFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other.manager)
+                other.manager(Operation::Move, &storage, &other.storage);
+            invoker = other.invoker;
+            manager = other.manager;
+        }
+        return *this;
+    }
+
+    ~FixedFunction()
+    {
+        reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return invoker != nullptr;
+    }
+
+    Ret operator()(Args... args) const
+    {
+        jassert(invoker != nullptr);
+        return invoker(const_cast<void*>(static_cast<const void*>(&storage)), std::forward<Args>(args)...);
+    }
+
+private:
+    enum class Operation
+    {
+        Copy,
+        Move,
+        Destroy
+    };
+
+    using Invoker = Ret (*)(void*, Args...);
+    using Manager = void (*)(Operation, void*, void*);
+
+    void reset() noexcept
+    {
+        if (manager)
+            manager(Operation::Destroy, &storage, nullptr);
+        invoker = nullptr;
+        manager = nullptr;
+    }
+
+    alignas(std::max_align_t) unsigned char storage[Capacity];
+    Invoker invoker { nullptr };
+    Manager manager { nullptr };
+};
+
+}
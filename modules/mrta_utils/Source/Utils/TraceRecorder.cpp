@@ -0,0 +1,246 @@
+namespace mrta
+{
+
+namespace
+{
+
+// Buffer claimed by the calling thread. It is handed back when the thread
+// exits, and the writer frees it for another thread once it is drained, so
+// short lived worker threads do not use up the buffers.
+struct ThreadBufferClaim
+{
+    ~ThreadBufferClaim()
+    {
+        if (released != nullptr)
+            released->store(true, std::memory_order_release);
+    }
+
+    void* buffer { nullptr };
+    std::atomic<bool>* released { nullptr };
+};
+
+thread_local ThreadBufferClaim currentThreadBuffer;
+
+}
+
+TraceRecorder& TraceRecorder::getInstance()
+{
+    // Constructed on first use, so it costs nothing at library load
+    static TraceRecorder instance;
+    return instance;
+}
+
+TraceRecorder::TraceRecorder() :
+    juce::Thread { "Trace writer" }
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    // Every user should have stopped by now, finish the file anyway
+    if (numUsers > 0)
+    {
+        numUsers = 1;
+        stop();
+    }
+}
+
+bool TraceRecorder::start(const juce::File& file)
+{
+    const std::lock_guard<std::mutex> lock { sessionMutex };
+    if (numUsers > 0)
+    {
+        ++numUsers;
+        return true;
+    }
+
+    file.deleteFile();
+    auto stream { std::make_unique<juce::FileOutputStream>(file) };
+    if (!stream->openedOk())
+        return false;
+
+    output = std::move(stream);
+    *output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    firstEvent = true;
+    threadNamed.fill(false);
+
+    // All rings are allocated by the first trace and kept, so claiming one
+    // on the audio thread never allocates
+    for (auto& b : buffers)
+    {
+        if (b == nullptr)
+            b = std::make_unique<ThreadBuffer>();
+        b->fifo.reset();
+        if (b->released.load(std::memory_order_acquire))
+            releaseThreadBuffer(*b);
+    }
+    numDroppedEvents.store(0);
+
+    origin = std::chrono::steady_clock::now();
+    numUsers = 1;
+    enabled.store(true);
+    startThread();
+    return true;
+}
+
+bool TraceRecorder::startFromEnvironment(const char* variableName)
+{
+#if MRTA_ENABLE_TRACE
+    const auto path { juce::SystemStats::getEnvironmentVariable(variableName, {}) };
+    if (path.isEmpty())
+        return false;
+
+    return start(juce::File::getCurrentWorkingDirectory().getChildFile(path));
+#else
+    // Without the scopes compiled in the trace would stay empty
+    juce::ignoreUnused(variableName);
+    return false;
+#endif
+}
+
+void TraceRecorder::stop()
+{
+    const std::lock_guard<std::mutex> lock { sessionMutex };
+    if (numUsers == 0 || --numUsers > 0)
+        return;
+
+    enabled.store(false);
+    stopThread(1000);
+    drain();
+    *output << "\n],\"otherData\":{\"droppedEvents\":\"" << juce::String(numDroppedEvents.load()) << "\"}}\n";
+    if (numDroppedEvents.load() > 0)
+        DBG("Trace dropped " << juce::String(numDroppedEvents.load()) << " events");
+    output->flush();
+    output.reset();
+}
+
+void TraceRecorder::begin(const char* name, const char* category) noexcept
+{
+    record(name, category, 'B');
+}
+
+void TraceRecorder::end(const char* name, const char* category) noexcept
+{
+    record(name, category, 'E');
+}
+
+void TraceRecorder::record(const char* name, const char* category, char phase) noexcept
+{
+    // Acquire pairs with start, so the rings are visible once enabled
+    if (!enabled.load(std::memory_order_acquire))
+        return;
+
+    auto* buffer { getThreadBuffer(category) };
+    if (buffer == nullptr || buffer->fifo.getFreeSpace() == 0)
+    {
+        numDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const auto elapsed { std::chrono::steady_clock::now() - origin };
+    const Event event { name, category, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), phase };
+
+    auto scope { buffer->fifo.write(1) };
+    if (scope.blockSize1 > 0)
+        buffer->events[static_cast<size_t>(scope.startIndex1)] = event;
+    else if (scope.blockSize2 > 0)
+        buffer->events[static_cast<size_t>(scope.startIndex2)] = event;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::getThreadBuffer(const char* category) noexcept
+{
+    auto& claim { currentThreadBuffer };
+    if (claim.buffer != nullptr)
+        return static_cast<ThreadBuffer*>(claim.buffer);
+
+    for (auto& b : buffers)
+    {
+        bool expected { false };
+        if (b->claimed.compare_exchange_strong(expected, true))
+        {
+            b->isMessageThread = juce::MessageManager::existsAndIsCurrentThread();
+            b->firstCategory = category;
+            b->threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+            b->ready.store(true, std::memory_order_release);
+            claim.buffer = b.get();
+            claim.released = &b->released;
+            return b.get();
+        }
+    }
+
+    return nullptr;
+}
+
+void TraceRecorder::releaseThreadBuffer(ThreadBuffer& buffer)
+{
+    buffer.ready.store(false);
+    buffer.released.store(false);
+    buffer.fifo.reset();
+    buffer.claimed.store(false, std::memory_order_release);
+}
+
+void TraceRecorder::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(50);
+        drain();
+    }
+}
+
+void TraceRecorder::drain()
+{
+    for (size_t t { 0 }; t < buffers.size(); ++t)
+    {
+        auto& buffer { *buffers[t] };
+        if (!buffer.ready.load(std::memory_order_acquire))
+            continue;
+
+        // Checked before reading, so every event of an exited thread is
+        // written before its buffer goes back to the pool
+        const bool released { buffer.released.load(std::memory_order_acquire) };
+        const auto tid { juce::String(buffer.threadId) };
+        auto writeEvent = [this] (const juce::String& json)
+        {
+            *output << (firstEvent ? "" : ",\n") << json;
+            firstEvent = false;
+        };
+
+        if (!threadNamed[t])
+        {
+            const auto threadName { buffer.isMessageThread ? juce::String("Message thread")
+                                                           : "Thread " + tid + " (" + buffer.firstCategory + ")" };
+            writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid
+                       + ",\"args\":{\"name\":\"" + threadName + "\"}}");
+            threadNamed[t] = true;
+        }
+
+        const int numReady { buffer.fifo.getNumReady() };
+        if (numReady == 0)
+        {
+            if (released)
+            {
+                threadNamed[t] = false;
+                releaseThreadBuffer(buffer);
+            }
+            continue;
+        }
+
+        auto scope { buffer.fifo.read(numReady) };
+        auto writeRange = [&] (int start, int size)
+        {
+            for (int i { start }; i < start + size; ++i)
+            {
+                const auto& e { buffer.events[static_cast<size_t>(i)] };
+                writeEvent(juce::String("{\"name\":\"") + e.name + "\",\"cat\":\"" + e.category
+                           + "\",\"ph\":\"" + juce::String::charToString(e.phase)
+                           + "\",\"ts\":" + juce::String(e.timestampUs)
+                           + ",\"pid\":1,\"tid\":" + tid + "}");
+            }
+        };
+        writeRange(scope.startIndex1, scope.blockSize1);
+        writeRange(scope.startIndex2, scope.blockSize2);
+    }
+}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mrta
+{
+
+// Opt-in recorder of begin/end events, written as a Chrome trace-event
+// JSON file that chrome://tracing and ui.perfetto.dev can load.
+// Every thread records into its own preallocated lock-free ring, claimed
+// on its first event and handed back when the thread exits, and a
+// background thread drains the rings to disk. Recording points are only compiled in with
+// MRTA_ENABLE_TRACE, and then cost one atomic load while no trace runs.
+class TraceRecorder : private juce::Thread
+{
+public:
+    static constexpr int MaxThreads { 32 };
+    static constexpr int EventsPerThread { 1 << 14 };
+
+    // Get the process wide recorder
+    static TraceRecorder& getInstance();
+
+    // Starts writing a trace to file, or only adds a user if a trace is
+    // already running. Every successful start must be balanced by a stop.
+    // Returns false if the file could not be opened. Not real-time safe.
+    bool start(const juce::File& file);
+
+    // Starts a trace if the environment variable names an output file
+    bool startFromEnvironment(const char* variableName);
+
+    // Removes a user, the trace is finished and closed by the last one
+    void stop();
+
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // Real-time safe. Names and categories are not copied, they must be
+    // string literals and should not need escaping in JSON.
+    void begin(const char* name, const char* category) noexcept;
+    void end(const char* name, const char* category) noexcept;
+
+    // Events lost in the current or last trace because a thread ring was
+    // full or too many threads recorded at once, also written to the trace
+    uint64_t getNumDroppedEvents() const noexcept { return numDroppedEvents.load(); }
+
+private:
+    TraceRecorder();
+    ~TraceRecorder() override;
+
+    struct Event
+    {
+        const char* name { nullptr };
+        const char* category { nullptr };
+        juce::int64 timestampUs { 0 };
+        char phase { 'B' };
+    };
+
+    struct ThreadBuffer
+    {
+        ThreadBuffer() : fifo { EventsPerThread }, events(static_cast<size_t>(EventsPerThread)) { }
+
+        juce::AbstractFifo fifo;
+        std::vector<Event> events;
+        std::atomic<bool> claimed { false };
+        std::atomic<bool> ready { false };
+        // Set when the owning thread exits
+        std::atomic<bool> released { false };
+        int threadId { 0 };
+        bool isMessageThread { false };
+        const char* firstCategory { nullptr };
+    };
+
+    void record(const char* name, const char* category, char phase) noexcept;
+    ThreadBuffer* getThreadBuffer(const char* category) noexcept;
+    // Makes a drained buffer of an exited thread claimable again
+    void releaseThreadBuffer(ThreadBuffer& buffer);
+    void run() override;
+    void drain();
+
+    std::atomic<bool> enabled { false };
+    std::atomic<uint64_t> numDroppedEvents { 0 };
+    std::atomic<int> nextThreadId { 1 };
+    std::chrono::steady_clock::time_point origin;
+
+    std::array<std::unique_ptr<ThreadBuffer>, MaxThreads> buffers;
+
+    // Only touched by start, stop and the writer thread
+    std::mutex sessionMutex;
+    int numUsers { 0 };
+    std::unique_ptr<juce::FileOutputStream> output;
+    std::array<bool, MaxThreads> threadNamed { };
+    bool firstEvent { true };
+
+    JUCE_DECLARE_NON_COPYABLE(TraceRecorder)
+    JUCE_DECLARE_NON_MOVEABLE(TraceRecorder)
+};
+
+// Records a begin event now and the matching end event when destroyed
+class TraceScope
+{
+public:
+    TraceScope(const char* _name, const char* _category) noexcept :
+        name { _name },
+        category { _category },
+        active { TraceRecorder::getInstance().isEnabled() }
+    {
+        if (active)
+            TraceRecorder::getInstance().begin(name, category);
+    }
+
+    ~TraceScope()
+    {
+        if (active)
+            TraceRecorder::getInstance().end(name, category);
+    }
+
+private:
+    const char* name;
+    const char* category;
+    const bool active;
+
+    JUCE_DECLARE_NON_COPYABLE(TraceScope)
+    JUCE_DECLARE_NON_MOVEABLE(TraceScope)
+};
+
+}
+
+#if MRTA_ENABLE_TRACE
+ #define MRTA_TRACE_SCOPE(name, category) \
+    mrta::TraceScope JUCE_JOIN_MACRO(mrtaTraceScope, __LINE__) { name, category }
+#else
+ #define MRTA_TRACE_SCOPE(name, category)
+#endif
@@ -9,5 +9,7 @@
 
 #include "mrta_utils.h"
 
+#include "Source/Utils/TraceRecorder.cpp"
 #include "Source/Parameter/ParameterManager.cpp"
+#include "Source/DSP/SharedResourceCache.cpp"
 #include "Source/GUI/GenericParameterEditor.cpp"
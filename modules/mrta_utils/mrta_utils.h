@@ -20,11 +20,24 @@
 
 #define MRTA_UTILS_H_INCLUDED
 
+/** Config: MRTA_ENABLE_TRACE
+    Compiles in the MRTA_TRACE_SCOPE recording points. When off, the
+    scopes expand to nothing and no trace can be recorded.
+*/
+#ifndef MRTA_ENABLE_TRACE
+ #define MRTA_ENABLE_TRACE 0
+#endif
+
 #include <juce_audio_processors/juce_audio_processors.h>
 
+#include "Source/Utils/FixedFunction.h"
+#include "Source/Utils/TraceRecorder.h"
 #include "Source/Parameter/ParameterFIFO.h"
+#include "Source/Parameter/ParameterChangeQueue.h"
 #include "Source/Parameter/ParameterInfo.h"
+#include "Source/Parameter/ParameterDescriptor.h"
 #include "Source/Parameter/ParameterManager.h"
+#include "Source/DSP/SharedResourceCache.h"
 #include "Source/GUI/ParameterComponents.h"
 #include "Source/GUI/GenericParameterEditor.h"
 
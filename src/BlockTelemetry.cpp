@@ -0,0 +1,106 @@
+#include "BlockTelemetry.h"
+
+BlockTelemetry::BlockTelemetry() : overrunFifo(OverrunCapacity) {}
+
+void BlockTelemetry::prepare(double newSampleRate) {
+  if (overruns == nullptr) {
+    overruns = std::make_unique<Overrun[]>(OverrunCapacity);
+  }
+  sampleRate = newSampleRate;
+  nanosecondsPerSample = newSampleRate > 0.0 ? 1.0e9 / newSampleRate : 0.0;
+
+  for (auto &bucket : buckets) {
+    bucket.store(0);
+  }
+  numBlocks.store(0);
+  numOverruns.store(0);
+  numDroppedOverruns.store(0);
+  maxDeadlineFraction.store(0.0f);
+}
+
+void BlockTelemetry::record(float deadlineFraction) noexcept {
+  const auto bucket =
+      juce::jlimit(0, NumBuckets - 1,
+                   static_cast<int>(deadlineFraction * BucketsPerDeadline));
+  buckets[static_cast<size_t>(bucket)].fetch_add(1, std::memory_order_relaxed);
+  numBlocks.fetch_add(1, std::memory_order_relaxed);
+
+  // The audio thread is the only writer, so no compare and swap is needed
+  if (deadlineFraction > maxDeadlineFraction.load(std::memory_order_relaxed)) {
+    maxDeadlineFraction.store(deadlineFraction, std::memory_order_relaxed);
+  }
+}
+
+void BlockTelemetry::pushOverrun(const Overrun &overrun) noexcept {
+  numOverruns.fetch_add(1, std::memory_order_relaxed);
+  if (overrunFifo.getFreeSpace() == 0) {
+    numDroppedOverruns.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  auto scope = overrunFifo.write(1);
+  if (scope.blockSize1 > 0) {
+    overruns[static_cast<size_t>(scope.startIndex1)] = overrun;
+  } else if (scope.blockSize2 > 0) {
+    overruns[static_cast<size_t>(scope.startIndex2)] = overrun;
+  }
+}
+
+BlockTelemetry::Histogram BlockTelemetry::getHistogram() const noexcept {
+  Histogram histogram;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    histogram[i] = buckets[i].load(std::memory_order_relaxed);
+  }
+  return histogram;
+}
+
+void BlockTelemetry::drainOverruns(std::vector<Overrun> &out) {
+  const int numReady = overrunFifo.getNumReady();
+  if (numReady == 0) {
+    return;
+  }
+
+  auto scope = overrunFifo.read(numReady);
+  for (int i = 0; i < scope.blockSize1; ++i) {
+    out.push_back(overruns[static_cast<size_t>(scope.startIndex1 + i)]);
+  }
+  for (int i = 0; i < scope.blockSize2; ++i) {
+    out.push_back(overruns[static_cast<size_t>(scope.startIndex2 + i)]);
+  }
+}
+
+bool BlockTelemetry::appendOverrunsToFile(const juce::File &file) {
+  std::vector<Overrun> pending;
+  drainOverruns(pending);
+  if (pending.empty()) {
+    return true;
+  }
+
+  const bool isNewFile = !file.existsAsFile();
+  juce::FileOutputStream stream(file);
+  if (!stream.openedOk()) {
+    return false;
+  }
+
+  if (isNewFile) {
+    stream << "time_ms,sample_rate,block_size,deadline_fraction,frogginess";
+    for (const auto &descriptor : Param::Descriptors) {
+      stream << ","
+             << juce::String(descriptor.ID.data(), descriptor.ID.size());
+    }
+    stream << "\n";
+  }
+
+  for (const auto &overrun : pending) {
+    stream << juce::String(overrun.timeMs) << ","
+           << juce::String(overrun.sampleRate) << ","
+           << juce::String(overrun.numSamples) << ","
+           << juce::String(overrun.deadlineFraction) << ","
+           << juce::String(overrun.frogginess);
+    for (auto value : overrun.parameters) {
+      stream << "," << juce::String(value);
+    }
+    stream << "\n";
+  }
+  return stream.getStatus().wasOk();
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Parameters.h"
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Per-block deadline telemetry. The audio thread timestamps every block with
+// a monotonic clock and records the processing time as a fraction of the
+// real-time deadline (block length / sample rate) in a lock-free histogram.
+// Blocks which miss the deadline are also pushed to a preallocated overrun
+// ring, which the message thread drains to disk or to the editor. Recording
+// costs two clock reads and one relaxed atomic increment per block, so it is
+// always on.
+class BlockTelemetry {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Histogram buckets are 1/16 of the deadline wide and cover up to twice the
+  // deadline, the last bucket also holds everything slower than that
+  static constexpr int BucketsPerDeadline = 16;
+  static constexpr int NumBuckets = 2 * BucketsPerDeadline;
+  static constexpr int OverrunCapacity = 256;
+
+  using Histogram = std::array<uint64_t, NumBuckets>;
+
+  // One block which took longer than its deadline
+  struct Overrun {
+    juce::int64 timeMs = 0;
+    double sampleRate = 0.0;
+    int numSamples = 0;
+    float deadlineFraction = 0.0f;
+    float frogginess = 0.0f;
+    std::array<float, Param::Count> parameters{};
+  };
+
+  BlockTelemetry();
+
+  // Not real-time safe, call from prepareToPlay. Clears the histogram and
+  // allocates the overrun ring on the first call, so unprepared instances
+  // (e.g. during plugin scans) stay small.
+  void prepare(double sampleRate);
+
+  // Audio thread
+  Clock::time_point beginBlock() const noexcept { return Clock::now(); }
+
+  // Audio thread. fillOverrun(Overrun &) is only called for blocks which
+  // missed their deadline, to snapshot the processor state.
+  template <typename FillOverrun>
+  void endBlock(Clock::time_point start, int numSamples,
+                FillOverrun &&fillOverrun) noexcept {
+    const auto elapsed = Clock::now() - start;
+    if (numSamples <= 0 || nanosecondsPerSample <= 0.0) {
+      return;
+    }
+
+    const auto deadlineFraction = static_cast<float>(
+        std::chrono::duration<double, std::nano>(elapsed).count() /
+        (nanosecondsPerSample * numSamples));
+    record(deadlineFraction);
+
+    if (deadlineFraction > 1.0f) {
+      Overrun overrun;
+      overrun.timeMs = juce::Time::currentTimeMillis();
+      overrun.sampleRate = sampleRate;
+      overrun.numSamples = numSamples;
+      overrun.deadlineFraction = deadlineFraction;
+      fillOverrun(overrun);
+      pushOverrun(overrun);
+    }
+  }
+
+  // Message thread
+  Histogram getHistogram() const noexcept;
+  uint64_t getNumBlocks() const noexcept { return numBlocks.load(); }
+  uint64_t getNumOverruns() const noexcept { return numOverruns.load(); }
+  // Overruns lost because the ring was full when they happened
+  uint64_t getNumDroppedOverruns() const noexcept {
+    return numDroppedOverruns.load();
+  }
+  float getMaxDeadlineFraction() const noexcept {
+    return maxDeadlineFraction.load();
+  }
+
+  // Message thread, moves all pending overruns out of the ring. Only one
+  // thread may drain.
+  void drainOverruns(std::vector<Overrun> &out);
+
+  // Message thread, drains all pending overruns and appends them to a CSV
+  // file, writing the header if the file is new. Returns false if the file
+  // could not be written.
+  bool appendOverrunsToFile(const juce::File &file);
+
+private:
+  void record(float deadlineFraction) noexcept;
+  void pushOverrun(const Overrun &overrun) noexcept;
+
+  double sampleRate = 0.0;
+  double nanosecondsPerSample = 0.0;
+
+  std::array<std::atomic<uint64_t>, NumBuckets> buckets{};
+  std::atomic<uint64_t> numBlocks{0};
+  std::atomic<uint64_t> numOverruns{0};
+  std::atomic<uint64_t> numDroppedOverruns{0};
+  std::atomic<float> maxDeadlineFraction{0.0f};
+
+  juce::AbstractFifo overrunFifo;
+  std::unique_ptr<Overrun[]> overruns;
+
+  JUCE_DECLARE_NON_COPYABLE(BlockTelemetry)
+};
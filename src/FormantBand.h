@@ -0,0 +1,107 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Coefficients of one formant band: the state variable filter coefficients
+// (named as in juce::dsp::StateVariableTPTFilter) and the band output gain
+struct FormantCoefficients {
+  float g = 0.0f;
+  float R2 = 1.0f;
+  float h = 1.0f;
+  float gain = 1.0f;
+
+  static FormantCoefficients make(double sampleRate, float centreFrequency,
+                                  float resonance, float gainDb) {
+    FormantCoefficients c;
+    c.g = static_cast<float>(
+        std::tan(juce::MathConstants<double>::pi * centreFrequency / sampleRate));
+    c.R2 = static_cast<float>(1.0 / resonance);
+    c.h = static_cast<float>(1.0 / (1.0 + c.R2 * c.g + c.g * c.g));
+    c.gain = juce::Decibels::decibelsToGain(gainDb);
+    return c;
+  }
+
+  static FormantCoefficients interpolate(const FormantCoefficients &a,
+                                         const FormantCoefficients &b,
+                                         float t) noexcept {
+    return {a.g + (b.g - a.g) * t, a.R2 + (b.R2 - a.R2) * t,
+            a.h + (b.h - a.h) * t, a.gain + (b.gain - a.gain) * t};
+  }
+};
+
+// A bandpass formant band: a topology preserving transform state variable
+// filter, same structure as juce::dsp::StateVariableTPTFilter, followed by
+// the band gain. The coefficients are set from outside, so they can come
+// from a shared table and be interpolated without recomputing them.
+class FormantBand {
+public:
+  void prepare(const juce::dsp::ProcessSpec &spec) {
+    s1.assign(spec.numChannels, 0.0f);
+    s2.assign(spec.numChannels, 0.0f);
+  }
+
+  void reset() {
+    std::fill(s1.begin(), s1.end(), 0.0f);
+    std::fill(s2.begin(), s2.end(), 0.0f);
+  }
+
+  void setCoefficients(const FormantCoefficients &newCoefficients) noexcept {
+    coefficients = newCoefficients;
+  }
+
+  const FormantCoefficients &getCoefficients() const noexcept {
+    return coefficients;
+  }
+
+  float processSample(size_t channel, float input,
+                      const FormantCoefficients &c) noexcept {
+    auto &ls1 = s1[channel];
+    auto &ls2 = s2[channel];
+
+    auto yHP = c.h * (input - ls1 * (c.g + c.R2) - ls2);
+    auto yBP = yHP * c.g + ls1;
+    ls1 = yHP * c.g + yBP;
+    auto yLP = yBP * c.g + ls2;
+    ls2 = yBP * c.g + yLP;
+
+    return yBP * c.gain;
+  }
+
+  float processSample(size_t channel, float input) noexcept {
+    return processSample(channel, input, coefficients);
+  }
+
+  // Flushes denormal filter states, call after every processed block
+  void snapToZero() noexcept {
+    for (auto &v : s1) {
+      juce::dsp::util::snapToZero(v);
+    }
+    for (auto &v : s2) {
+      juce::dsp::util::snapToZero(v);
+    }
+  }
+
+  template <typename ProcessContext>
+  void process(const ProcessContext &context) noexcept {
+    auto &inputBlock = context.getInputBlock();
+    auto &outputBlock = context.getOutputBlock();
+    if (context.isBypassed) {
+      outputBlock.copyFrom(inputBlock);
+      return;
+    }
+    jassert(outputBlock.getNumChannels() <= s1.size());
+    for (size_t ch = 0; ch < outputBlock.getNumChannels(); ++ch) {
+      auto *in = inputBlock.getChannelPointer(ch);
+      auto *out = outputBlock.getChannelPointer(ch);
+      for (size_t i = 0; i < outputBlock.getNumSamples(); ++i) {
+        out[i] = processSample(ch, in[i]);
+      }
+    }
+    snapToZero();
+  }
+
+private:
+  FormantCoefficients coefficients;
+  std::vector<float> s1, s2;
+};
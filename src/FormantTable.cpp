@@ -0,0 +1,45 @@
+#include "FormantTable.h"
+
+FormantTable::FormantTable(double sr, int res)
+    : sampleRate(sr), resolution(juce::jmax(1, res)) {
+  grid.reserve(static_cast<size_t>(resolution) + 1);
+  for (int i = 0; i <= resolution; ++i) {
+    grid.push_back(compute(sampleRate, static_cast<float>(i) /
+                                           static_cast<float>(resolution)));
+  }
+}
+
+FormantTable::Bands FormantTable::compute(double rate,
+                                          float frogginess) {
+  const float resonance =
+      juce::jmap(frogginess, 0.0f, 1.0f, MinResonance, MaxResonance);
+  const float gainDb = juce::jmap(frogginess, 0.0f, 1.0f, 0.0f, MaxGainDb);
+
+  Bands bands;
+  for (size_t band = 0; band < NumBands; ++band) {
+    bands[band] = FormantCoefficients::make(
+        rate, CentreFrequencies[band], resonance, gainDb);
+  }
+  return bands;
+}
+
+void FormantTable::lookup(float frogginess, Bands &out) const noexcept {
+  const float position =
+      juce::jlimit(0.0f, 1.0f, frogginess) * static_cast<float>(resolution);
+  const int index = juce::jmin(static_cast<int>(position), resolution - 1);
+  const float t = position - static_cast<float>(index);
+
+  const auto &a = grid[static_cast<size_t>(index)];
+  const auto &b = grid[static_cast<size_t>(index) + 1];
+  for (size_t band = 0; band < NumBands; ++band) {
+    out[band] = FormantCoefficients::interpolate(a[band], b[band], t);
+  }
+}
+
+std::shared_ptr<const FormantTable>
+FormantTable::getShared(double rate, int quality) {
+  return mrta::SharedResourceCache::getInstance().get<FormantTable>(
+      rate, quality, [](double sr, int res) {
+        return std::make_shared<const FormantTable>(sr, res);
+      });
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "FormantBand.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// Precomputed formant band coefficients over a grid of frogginess values,
+// for one sample rate. Tables are immutable and shared by all instances
+// through mrta::SharedResourceCache, keyed by sample rate and resolution.
+class FormantTable {
+public:
+  static constexpr size_t NumBands = 3;
+  static constexpr std::array<float, NumBands> CentreFrequencies{200.0f, 700.0f,
+                                                                 1400.0f};
+  static constexpr float MinResonance = 1.0f;
+  static constexpr float MaxResonance = 5.0f;
+  static constexpr float MaxGainDb = 18.0f;
+
+  // Number of grid intervals, i.e. the table quality
+  static constexpr int DefaultResolution = 128;
+
+  using Bands = std::array<FormantCoefficients, NumBands>;
+
+  FormantTable(double sampleRate, int resolution);
+
+  // Exact coefficients of all bands for frogginess in [0, 1]
+  static Bands compute(double rate, float frogginess);
+
+  // Coefficients of all bands for frogginess in [0, 1], linearly
+  // interpolated between the two nearest grid points
+  void lookup(float frogginess, Bands &out) const noexcept;
+
+  double getSampleRate() const noexcept { return sampleRate; }
+  int getResolution() const noexcept { return resolution; }
+
+  // Get the table shared by all instances, builds it if needed.
+  // Not real-time safe, call from prepareToPlay.
+  static std::shared_ptr<const FormantTable>
+  getShared(double rate, int quality = DefaultResolution);
+
+private:
+  double sampleRate;
+  int resolution;
+  std::vector<Bands> grid;
+};
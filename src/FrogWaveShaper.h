@@ -0,0 +1,33 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+// This struct holds our stateful waveshaper logic
+struct FrogWaveShaper {
+  float frogginess = 0.0f;
+  void prepare(const juce::dsp::ProcessSpec &) {}
+  void reset() { frogginess = 0.0f; }
+
+  static float processSample(float input, float amount) noexcept {
+    auto distorted = std::tanh(input * (1.0f + amount * 4.0f));
+    return (input * (1.0f - amount)) + (distorted * amount);
+  }
+
+  template <typename ProcessContext>
+  void process(const ProcessContext &context) noexcept {
+    auto &inputBlock = context.getInputBlock();
+    auto &outputBlock = context.getOutputBlock();
+    if (context.isBypassed) {
+      outputBlock.copyFrom(inputBlock);
+      return;
+    }
+    for (size_t ch = 0; ch < outputBlock.getNumChannels(); ++ch) {
+      auto *in = inputBlock.getChannelPointer(ch);
+      auto *out = outputBlock.getChannelPointer(ch);
+      for (size_t i = 0; i < outputBlock.getNumSamples(); ++i) {
+        out[i] = processSample(in[i], frogginess);
+      }
+    }
+  }
+};
@@ -0,0 +1,115 @@
+#include "MorphEngine.h"
+#include "FrogWaveShaper.h"
+
+void MorphEngine::prepare(double sampleRate) {
+  position.reset(sampleRate, 0.02);
+}
+
+void MorphEngine::setSnapshot(size_t slot, float frogginess, float outputGain,
+                              const FormantTable &table) noexcept {
+  jassert(slot < NumSnapshots);
+  auto &snapshot = snapshots[slot];
+  table.lookup(frogginess, snapshot.bands);
+  snapshot.frogginess = frogginess;
+  snapshot.outputGain = outputGain;
+}
+
+void MorphEngine::setPosition(float newPosition, bool force) noexcept {
+  if (force) {
+    position.setCurrentAndTargetValue(newPosition);
+  } else {
+    position.setTargetValue(newPosition);
+  }
+}
+
+MorphEngine::Ramp MorphEngine::advance(int numSamples) noexcept {
+  Ramp ramp;
+  ramp.start = position.getCurrentValue();
+  if (numSamples > 0 && position.isSmoothing()) {
+    const float end = position.skip(numSamples);
+    ramp.delta = (end - ramp.start) / static_cast<float>(numSamples);
+  }
+  return ramp;
+}
+
+MorphEngine::Segment MorphEngine::segmentAt(float pos) noexcept {
+  constexpr auto numSegments = static_cast<float>(NumSnapshots - 1);
+  const float scaled = juce::jlimit(0.0f, 1.0f, pos) * numSegments;
+  const auto index =
+      juce::jmin(static_cast<size_t>(scaled), NumSnapshots - 2);
+  return {index, scaled - static_cast<float>(index)};
+}
+
+void MorphEngine::interpolate(float pos, size_t band,
+                              FormantCoefficients &out) const noexcept {
+  const auto segment = segmentAt(pos);
+  out = FormantCoefficients::interpolate(
+      snapshots[segment.index].bands[band],
+      snapshots[segment.index + 1].bands[band], segment.t);
+}
+
+float MorphEngine::interpolateFrogginess(float pos) const noexcept {
+  const auto segment = segmentAt(pos);
+  const float a = snapshots[segment.index].frogginess;
+  return a + (snapshots[segment.index + 1].frogginess - a) * segment.t;
+}
+
+float MorphEngine::interpolateOutputGain(float pos) const noexcept {
+  const auto segment = segmentAt(pos);
+  const float a = snapshots[segment.index].outputGain;
+  return a + (snapshots[segment.index + 1].outputGain - a) * segment.t;
+}
+
+void MorphEngine::processBand(size_t band, FormantBand &formantBand,
+                              juce::dsp::AudioBlock<float> &block,
+                              const Ramp &ramp) const noexcept {
+  const auto numSamples = block.getNumSamples();
+  if (ramp.isStatic()) {
+    FormantCoefficients coefficients;
+    interpolate(ramp.start, band, coefficients);
+    formantBand.setCoefficients(coefficients);
+    formantBand.process(juce::dsp::ProcessContextReplacing<float>(block));
+    return;
+  }
+
+  for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+    auto *samples = block.getChannelPointer(ch);
+    FormantCoefficients coefficients;
+    for (size_t i = 0; i < numSamples; ++i) {
+      interpolate(ramp.start + ramp.delta * static_cast<float>(i + 1), band,
+                  coefficients);
+      samples[i] = formantBand.processSample(ch, samples[i], coefficients);
+    }
+  }
+  formantBand.snapToZero();
+}
+
+void MorphEngine::processShaper(juce::dsp::AudioBlock<float> &block,
+                                const Ramp &ramp) const noexcept {
+  const auto numSamples = block.getNumSamples();
+  for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+    auto *samples = block.getChannelPointer(ch);
+    for (size_t i = 0; i < numSamples; ++i) {
+      const float amount = interpolateFrogginess(
+          ramp.start + ramp.delta * static_cast<float>(i + 1));
+      samples[i] = FrogWaveShaper::processSample(samples[i], amount);
+    }
+  }
+}
+
+void MorphEngine::processOutputGain(juce::dsp::AudioBlock<float> &block,
+                                    const Ramp &ramp) const noexcept {
+  if (ramp.isStatic()) {
+    block.multiplyBy(interpolateOutputGain(ramp.start));
+    return;
+  }
+
+  const auto numSamples = block.getNumSamples();
+  for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+    auto *samples = block.getChannelPointer(ch);
+    for (size_t i = 0; i < numSamples; ++i) {
+      samples[i] *= interpolateOutputGain(ramp.start +
+                                          ramp.delta * static_cast<float>(i + 1));
+    }
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "FormantTable.h"
+
+#include <JuceHeader.h>
+#include <array>
+
+// Morphs between four snapshots (A/B/C/D) with a single position control at
+// audio rate. Snapshots are resolved once into formant coefficients, shaper
+// amount and output gain, and a morph only interpolates between those
+// precomputed sets, so a moving position costs about as much as a static one.
+// Which values a snapshot holds is up to the owner, see
+// DynamicsAudioProcessor::storeMorphSnapshot.
+class MorphEngine {
+public:
+  static constexpr size_t NumSnapshots = 4;
+
+  struct Snapshot {
+    FormantTable::Bands bands{};
+    float frogginess = 0.0f;
+    float outputGain = 1.0f;
+  };
+
+  // Position ramp over one block, the position of sample i is
+  // start + delta * (i + 1)
+  struct Ramp {
+    float start = 0.0f;
+    float delta = 0.0f;
+    bool isStatic() const noexcept { return delta == 0.0f; }
+  };
+
+  void prepare(double sampleRate);
+
+  // Resolves frogginess in [0, 1] and a linear output gain into a snapshot
+  // slot, real-time safe
+  void setSnapshot(size_t slot, float frogginess, float outputGain,
+                   const FormantTable &table) noexcept;
+
+  // Morph position in [0, 1], A at 0 and D at 1
+  void setPosition(float newPosition, bool force) noexcept;
+
+  // Advances the position smoother by one block and returns its ramp
+  Ramp advance(int numSamples) noexcept;
+
+  // Snapshot interpolated at a position
+  void interpolate(float pos, size_t band,
+                   FormantCoefficients &out) const noexcept;
+  float interpolateFrogginess(float pos) const noexcept;
+  float interpolateOutputGain(float pos) const noexcept;
+
+  // Each stage processes the block in place, following the same ramp
+  void processBand(size_t band, FormantBand &formantBand,
+                   juce::dsp::AudioBlock<float> &block,
+                   const Ramp &ramp) const noexcept;
+  void processShaper(juce::dsp::AudioBlock<float> &block,
+                     const Ramp &ramp) const noexcept;
+  void processOutputGain(juce::dsp::AudioBlock<float> &block,
+                         const Ramp &ramp) const noexcept;
+
+private:
+  // Segment between two neighbouring snapshots and the fraction inside it
+  struct Segment {
+    size_t index;
+    float t;
+  };
+  static Segment segmentAt(float pos) noexcept;
+
+  std::array<Snapshot, NumSnapshots> snapshots{};
+  juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> position;
+};
@@ -0,0 +1,33 @@
+#include "MorphSlotsView.h"
+
+MorphSlotsView::MorphSlotsView(DynamicsAudioProcessor &processor) {
+  for (size_t i = 0; i < slots.size(); ++i) {
+    auto &slot = slots[i];
+    slot.name.setText(juce::String::charToString(
+                          static_cast<juce::juce_wchar>('A' + i)),
+                      juce::dontSendNotification);
+    slot.name.setJustificationType(juce::Justification::centred);
+    slot.store.setTooltip("Store Froginess and Output gain in this slot");
+    slot.recall.setTooltip("Set Froginess and Output gain from this slot");
+    slot.store.onClick = [&processor, i] { processor.storeMorphSnapshot(i); };
+    slot.recall.onClick = [&processor, i] {
+      processor.recallMorphSnapshot(i);
+    };
+    addAndMakeVisible(slot.name);
+    addAndMakeVisible(slot.store);
+    addAndMakeVisible(slot.recall);
+  }
+}
+
+void MorphSlotsView::resized() {
+  auto bounds = getLocalBounds().reduced(6, 4);
+  const int column = bounds.getWidth() / static_cast<int>(slots.size());
+  const int row = bounds.getHeight() / 2;
+  for (auto &slot : slots) {
+    auto area = bounds.removeFromLeft(column).reduced(2, 0);
+    auto top = area.removeFromTop(row);
+    slot.name.setBounds(top.removeFromLeft(16));
+    slot.store.setBounds(top.reduced(0, 2));
+    slot.recall.setBounds(area.withTrimmedLeft(16).reduced(0, 2));
+  }
+}
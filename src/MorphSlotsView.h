@@ -0,0 +1,26 @@
+#pragma once
+
+#include "PluginProcessor.h"
+
+#include <JuceHeader.h>
+
+// Store and recall buttons for the morph snapshot slots, one column per slot
+class MorphSlotsView : public juce::Component {
+public:
+  static constexpr int PreferredHeight = 56;
+
+  explicit MorphSlotsView(DynamicsAudioProcessor &processor);
+
+  void resized() override;
+
+private:
+  struct Slot {
+    juce::Label name;
+    juce::TextButton store{"Store"};
+    juce::TextButton recall{"Recall"};
+  };
+
+  std::array<Slot, MorphEngine::NumSnapshots> slots;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MorphSlotsView)
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <string_view>
+
+namespace Param {
+// Parameter indices, in the same order as the descriptor table below
+enum Index : uint32_t {
+  Enabled = 0,
+  OutputGain,
+  FroginessLevel,
+  MorphEnabled,
+  MorphPosition,
+  Count
+};
+
+namespace ID {
+inline constexpr std::string_view Enabled{"enabled"};
+inline constexpr std::string_view OutputGain{"output_gain"};
+inline constexpr std::string_view FroginessLevel{"froginess_level"};
+inline constexpr std::string_view MorphEnabled{"morph_enabled"};
+inline constexpr std::string_view MorphPosition{"morph_position"};
+} // namespace ID
+
+namespace Name {
+inline constexpr std::string_view Enabled{"Enabled"};
+inline constexpr std::string_view OutputGain{"Output gain"};
+inline constexpr std::string_view FroginessLevel{"Froginess level"};
+inline constexpr std::string_view MorphEnabled{"Morph"};
+inline constexpr std::string_view MorphPosition{"Morph position"};
+} // namespace Name
+
+namespace Ranges {
+inline constexpr std::string_view EnabledOff{"Off"};
+inline constexpr std::string_view EnabledOn{"On"};
+static constexpr float OutputGainMin{-24.0f};
+static constexpr float OutputGainMax{6.0f};
+static constexpr float OutputGainInc{0.1f};
+static constexpr float OutputGainSkw{2.0f};
+static constexpr float FroginessMin{0.0f};
+static constexpr float FroginessMax{100.0f};
+static constexpr float FroginessInc{1.0f};
+static constexpr float FroginessSkw{1.0f};
+static constexpr float MorphPositionMin{0.0f};
+static constexpr float MorphPositionMax{100.0f};
+static constexpr float MorphPositionInc{0.1f};
+static constexpr float MorphPositionSkw{1.0f};
+// Factory program names
+inline constexpr std::array<std::string_view, 5> ProgramNames{
+    "Clean", "Tadpole", "Tree Frog", "Bullfrog", "Full Croak"};
+} // namespace Ranges
+
+namespace Defaults {
+static constexpr bool ProcessorEnabledDefault{true};
+static constexpr float OutputGainDefault{0.0f};
+static constexpr float FroginessDefault{0.0f};
+static constexpr bool MorphEnabledDefault{false};
+static constexpr float MorphPositionDefault{0.0f};
+} // namespace Defaults
+
+namespace Units {
+inline constexpr std::string_view Percentage{"%"};
+inline constexpr std::string_view Db{"dB"};
+} // namespace Units
+
+// Constant initialised parameter table, the APVTS layout, the parameter
+// infos and the callback slots are all generated from it per instance
+inline constexpr std::array<mrta::ParameterDescriptor, Count> Descriptors{{
+    {
+        ID::Enabled,
+        Name::Enabled,
+        Ranges::EnabledOff,
+        Ranges::EnabledOn,
+        Defaults::ProcessorEnabledDefault,
+    },
+    {
+        ID::OutputGain,
+        Name::OutputGain,
+        Units::Db,
+        Defaults::OutputGainDefault,
+        Ranges::OutputGainMin,
+        Ranges::OutputGainMax,
+        Ranges::OutputGainInc,
+        Ranges::OutputGainSkw,
+    },
+    {
+        ID::FroginessLevel,
+        Name::FroginessLevel,
+        Units::Percentage,
+        Defaults::FroginessDefault,
+        Ranges::FroginessMin,
+        Ranges::FroginessMax,
+        Ranges::FroginessInc,
+        Ranges::FroginessSkw,
+    },
+    {
+        ID::MorphEnabled,
+        Name::MorphEnabled,
+        Ranges::EnabledOff,
+        Ranges::EnabledOn,
+        Defaults::MorphEnabledDefault,
+    },
+    {
+        ID::MorphPosition,
+        Name::MorphPosition,
+        Units::Percentage,
+        Defaults::MorphPositionDefault,
+        Ranges::MorphPositionMin,
+        Ranges::MorphPositionMax,
+        Ranges::MorphPositionInc,
+        Ranges::MorphPositionSkw,
+    },
+}};
+
+static_assert(mrta::findParameterIndex(Descriptors, ID::Enabled) == Enabled);
+static_assert(mrta::findParameterIndex(Descriptors, ID::OutputGain) ==
+              OutputGain);
+static_assert(mrta::findParameterIndex(Descriptors, ID::FroginessLevel) ==
+              FroginessLevel);
+static_assert(mrta::findParameterIndex(Descriptors, ID::MorphEnabled) ==
+              MorphEnabled);
+static_assert(mrta::findParameterIndex(Descriptors, ID::MorphPosition) ==
+              MorphPosition);
+} // namespace Param
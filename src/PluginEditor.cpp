@@ -3,21 +3,38 @@
 DynamicsAudioProcessorEditor::DynamicsAudioProcessorEditor(
     DynamicsAudioProcessor &p)
     : AudioProcessorEditor(&p), audioProcessor(p),
-      genericParameterEditor(audioProcessor.getParameterManager()) {
+      genericParameterEditor(audioProcessor.getParameterManager()),
+      morphSlotsView(audioProcessor),
+      stageProfilerView(audioProcessor.getStageProfiler()) {
   auto numParams = audioProcessor.getParameterManager().getParameters().size();
   auto paramHeight = genericParameterEditor.parameterWidgetHeight;
+  auto profilerHeight =
+      StageProfiler::Enabled ? StageProfilerView::PreferredHeight : 0;
 
-  setSize(300, numParams * paramHeight);
+  setSize(300, numParams * paramHeight + MorphSlotsView::PreferredHeight +
+                   profilerHeight);
   addAndMakeVisible(genericParameterEditor);
+  addAndMakeVisible(morphSlotsView);
+  if (StageProfiler::Enabled) {
+    addAndMakeVisible(stageProfilerView);
+  }
 }
 
 DynamicsAudioProcessorEditor::~DynamicsAudioProcessorEditor() {}
 
 void DynamicsAudioProcessorEditor::paint(juce::Graphics &g) {
+  MRTA_TRACE_SCOPE("Editor paint", "gui");
   g.fillAll(
       getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
 }
 
 void DynamicsAudioProcessorEditor::resized() {
-  genericParameterEditor.setBounds(getLocalBounds());
+  auto bounds = getLocalBounds();
+  if (stageProfilerView.isVisible()) {
+    stageProfilerView.setBounds(
+        bounds.removeFromBottom(StageProfilerView::PreferredHeight));
+  }
+  morphSlotsView.setBounds(
+      bounds.removeFromBottom(MorphSlotsView::PreferredHeight));
+  genericParameterEditor.setBounds(bounds);
 }
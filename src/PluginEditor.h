@@ -1,6 +1,8 @@
 #pragma once
 
+#include "MorphSlotsView.h"
 #include "PluginProcessor.h"
+#include "StageProfilerView.h"
 
 class DynamicsAudioProcessorEditor : public juce::AudioProcessorEditor {
 public:
@@ -13,6 +15,8 @@ public:
 private:
   DynamicsAudioProcessor &audioProcessor;
   mrta::GenericParameterEditor genericParameterEditor;
+  MorphSlotsView morphSlotsView;
+  StageProfilerView stageProfilerView;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynamicsAudioProcessorEditor)
 };
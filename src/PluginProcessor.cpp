@@ -1,45 +1,29 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "RealtimeCheck.h"
 #include "juce_audio_basics/juce_audio_basics.h"
-#include <vector>
-
-static const std::vector<mrta::ParameterInfo> Parameters{
-    {
-        Param::ID::Enabled,
-        Param::Name::Enabled,
-        Param::Ranges::EnabledOff,
-        Param::Ranges::EnabledOn,
-        Param::Defaults::ProcessorEnabledDefault,
-    },
-    {
-        Param::ID::OutputGain,
-        Param::Name::OutputGain,
-        Param::Units::Db,
-        Param::Defaults::OutputGainDefault,
-        Param::Ranges::OutputGainMin,
-        Param::Ranges::OutputGainMax,
-        Param::Ranges::OutputGainInc,
-        Param::Ranges::OutputGainSkw,
-    },
-    {
-        Param::ID::FroginessLevel,
-        Param::Name::FroginessLevel,
-        Param::Units::Percentage,
-        Param::Defaults::FroginessDefault,
-        Param::Ranges::FroginessMin,
-        Param::Ranges::FroginessMax,
-        Param::Ranges::FroginessInc,
-        Param::Ranges::FroginessSkw,
-    }};
+
+namespace {
+// Morph slots trail the parameter state: froginess and output gain of every
+// slot (float32 each), then version and magic (int32 each), little endian.
+// Reading it from the end keeps the parameter blob untouched.
+constexpr int morphStateMagic = 0x534d5246; // "FRMS"
+constexpr int morphStateVersion = 1;
+constexpr int morphStateSize =
+    static_cast<int>(MorphEngine::NumSnapshots * 2 * sizeof(float) +
+                     2 * sizeof(int));
+} // namespace
 
 DynamicsAudioProcessor::DynamicsAudioProcessor()
-    : parameterManager(*this, ProjectInfo::projectName, Parameters) {
+    : juce::AudioProcessor(createBusesProperties()),
+      parameterManager(*this, ProjectInfo::projectName,
+                       mrta::makeParameterInfos(Param::Descriptors)) {
   parameterManager.registerParameterCallback(
-      Param::ID::Enabled,
+      Param::Enabled,
       [this](float newValue, bool) { processorEnabled = (newValue > 0.5f); });
 
   parameterManager.registerParameterCallback(
-      Param::ID::OutputGain, [this](float newValueDb, bool forced) {
+      Param::OutputGain, [this](float newValueDb, bool forced) {
         auto linearGain = juce::Decibels::decibelsToGain(newValueDb);
         if (forced) {
           outputGainSmoother.setCurrentAndTargetValue(linearGain);
@@ -49,7 +33,7 @@ DynamicsAudioProcessor::DynamicsAudioProcessor()
       });
 
   parameterManager.registerParameterCallback(
-      Param::ID::FroginessLevel, [this](float newValue, bool forced) {
+      Param::FroginessLevel, [this](float newValue, bool forced) {
         float scaledValue = newValue / 100.0f;
         if (forced) {
           frogginessSmoother.setCurrentAndTargetValue(scaledValue);
@@ -57,113 +41,547 @@ DynamicsAudioProcessor::DynamicsAudioProcessor()
           frogginessSmoother.setTargetValue(scaledValue);
         }
       });
+
+  parameterManager.registerParameterCallback(
+      Param::MorphEnabled,
+      [this](float newValue, bool) { morphEnabled = (newValue > 0.5f); });
+
+  parameterManager.registerParameterCallback(
+      Param::MorphPosition, [this](float newValue, bool forced) {
+        morphEngine.setPosition(newValue / 100.0f, forced);
+      });
+
+  resetMorphSnapshots();
+}
+
+DynamicsAudioProcessor::~DynamicsAudioProcessor() {
+  stopTimer();
+  writeOverruns();
+  capture.stop();
+  if (tracing) {
+    mrta::TraceRecorder::getInstance().stop();
+  }
+}
+
+juce::AudioProcessor::BusesProperties
+DynamicsAudioProcessor::createBusesProperties() {
+  const auto stereo = juce::AudioChannelSet::stereo();
+  return BusesProperties()
+      .withInput("Input", stereo, true)
+      .withOutput("Output", stereo, true)
+      .withOutput("Dry", stereo, false)
+      .withOutput("Band 1", stereo, false)
+      .withOutput("Band 2", stereo, false)
+      .withOutput("Formant", stereo, false)
+      .withOutput("Shaped", stereo, false);
+}
+
+bool DynamicsAudioProcessor::isBusesLayoutSupported(
+    const BusesLayout &layouts) const {
+  const auto mainOutput = layouts.getMainOutputChannelSet();
+  if (mainOutput != juce::AudioChannelSet::mono() &&
+      mainOutput != juce::AudioChannelSet::stereo()) {
+    return false;
+  }
+  if (layouts.getMainInputChannelSet() != mainOutput) {
+    return false;
+  }
+
+  // Stems are copies of the main signal, so they either match it or are off
+  for (int bus = Bus::Dry; bus < layouts.outputBuses.size(); ++bus) {
+    const auto &stem = layouts.outputBuses.getReference(bus);
+    if (!stem.isDisabled() && stem != mainOutput) {
+      return false;
+    }
+  }
+  return true;
 }
 
-DynamicsAudioProcessor::~DynamicsAudioProcessor() {}
+void DynamicsAudioProcessor::writeStem(
+    juce::AudioBuffer<float> *buffer, int busIndex,
+    const juce::AudioBuffer<float> &source) {
+  if (buffer == nullptr) {
+    return;
+  }
+  FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Stems);
+  auto stem = getBusBuffer(*buffer, false, busIndex);
+  jassert(stem.getNumChannels() == 0 ||
+          stem.getNumChannels() == source.getNumChannels());
+  for (int ch = 0; ch < stem.getNumChannels(); ++ch) {
+    stem.copyFrom(ch, 0, source, ch, 0, source.getNumSamples());
+  }
+}
 
 void DynamicsAudioProcessor::prepareToPlay(double sampleRate,
                                            int samplesPerBlock) {
   currentSampleRate = sampleRate;
+
+  // Opt-in diagnostics start with the first prepare, so plugin scans never
+  // open files or start threads. FROGIFY_TRACE names the Chrome trace file
+  // to write, FROGIFY_CAPTURE the session capture, which only one instance
+  // per process records, FROGIFY_OVERRUNS the CSV file every instance
+  // appends its deadline overruns to.
+  if (!diagnosticsStarted) {
+    diagnosticsStarted = true;
+    tracing = mrta::TraceRecorder::getInstance().startFromEnvironment(
+        "FROGIFY_TRACE");
+    capture.startFromEnvironment("FROGIFY_CAPTURE");
+    const auto overrunPath =
+        juce::SystemStats::getEnvironmentVariable("FROGIFY_OVERRUNS", {});
+    if (overrunPath.isNotEmpty()) {
+      overrunLog =
+          juce::File::getCurrentWorkingDirectory().getChildFile(overrunPath);
+    }
+  }
+
   juce::dsp::ProcessSpec spec{
       sampleRate, static_cast<juce::uint32>(samplesPerBlock),
       static_cast<juce::uint32>(getMainBusNumOutputChannels())};
 
-  processorChain.prepare(spec);
+  livePath.chain.prepare(spec);
+  fadePath.chain.prepare(spec);
+  // The table may be for another rate now, so the next block looks it up
+  livePath.coefficientFrogginess = -1.0f;
 
-  // Configure the static properties of the formant filters once
-  processorChain.get<0>().get<0>().setType(
-      juce::dsp::StateVariableTPTFilterType::bandpass);
-  processorChain.get<0>().get<0>().setCutoffFrequency(200.0f);
-  processorChain.get<1>().get<0>().setType(
-      juce::dsp::StateVariableTPTFilterType::bandpass);
-  processorChain.get<1>().get<0>().setCutoffFrequency(700.0f);
-  processorChain.get<2>().get<0>().setType(
-      juce::dsp::StateVariableTPTFilterType::bandpass);
-  processorChain.get<2>().get<0>().setCutoffFrequency(1400.0f);
+  // Formant coefficients are shared with every other instance running at
+  // the same sample rate
+  formantTable = FormantTable::getShared(sampleRate);
+  programCoefficients = ProgramBank::getSharedCoefficients(sampleRate);
+  morphEngine.prepare(sampleRate);
+  pendingMorphSlots.store((1u << MorphEngine::NumSnapshots) - 1);
+  updateMorphSnapshots();
 
-  lfo.prepare(spec);
-  lfo.setFrequency(8.0f);
+  fadeBuffer.setSize(getMainBusNumOutputChannels(), samplesPerBlock);
+  fadeLength = juce::roundToInt(sampleRate * ProgramFadeSeconds);
+  fadeRemaining = 0;
 
   outputGainSmoother.reset(sampleRate, 0.05);
   frogginessSmoother.reset(sampleRate, 0.05);
+  telemetry.prepare(sampleRate);
+
+  // Program sync only matters once audio runs. Starting the timer here
+  // rather than in the constructor keeps plugin scans cheap.
+  if (!isTimerRunning()) {
+    startTimerHz(20);
+  }
 
   parameterManager.updateParameters(true);
+
+  if (capture.isActive()) {
+    SessionCapture::MorphSlots slots;
+    for (size_t slot = 0; slot < slots.size(); ++slot) {
+      const auto values = getMorphSnapshot(slot);
+      slots[slot] = {values.froginess, values.outputGainDb};
+    }
+    capture.capturePrepare(sampleRate, samplesPerBlock,
+                           getMainBusNumInputChannels(), getParameterValues(),
+                           slots);
+  }
 }
 
 void DynamicsAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer,
                                           juce::MidiBuffer &) {
+  FROGIFY_REALTIME_SCOPE();
+  MRTA_TRACE_SCOPE("processBlock", "audio");
+  const auto blockStart = telemetry.beginBlock();
+
+  processAudio(buffer);
+
+  telemetry.endBlock(blockStart, buffer.getNumSamples(),
+                     [this](BlockTelemetry::Overrun &overrun) {
+                       overrun.frogginess =
+                           frogginessSmoother.getCurrentValue();
+                       overrun.parameters = getParameterValues();
+                     });
+}
+
+SessionCapture::Values DynamicsAudioProcessor::getParameterValues() {
+  SessionCapture::Values values;
+  for (uint32_t i = 0; i < Param::Count; ++i) {
+    auto *param = parameterManager.getParameter(i);
+    values[i] = param->convertFrom0to1(param->getValue());
+  }
+  return values;
+}
+
+void DynamicsAudioProcessor::processAudio(juce::AudioBuffer<float> &buffer) {
   juce::ScopedNoDenormals noDenormals;
-  parameterManager.updateParameters();
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::ParameterUpdate);
+    if (capture.isActive()) {
+      // The capture records exactly the events this block applies
+      parameterManager.updateParameters(
+          false, [this](uint32_t index, float value) {
+            capture.captureParameter(index, value);
+          });
+    } else {
+      parameterManager.updateParameters();
+    }
+    updateMorphSnapshots();
+  }
+
+  // The input shares channels with the main output, so work on that bus only
+  auto mainBuffer = getBusBuffer(buffer, false, Bus::Main);
+  const int numSamples = mainBuffer.getNumSamples();
+  writeStem(&buffer, Bus::Dry, mainBuffer);
+
+  // A program change swaps the whole parameter set at the block boundary.
+  // The outgoing program keeps running on a copy of the chain and is
+  // crossfaded into the new one, so neither the shaper nor the formants jump.
+  const int program = pendingProgram.exchange(-1);
+  if (program >= 0) {
+    capture.captureProgram(program);
+    startProgramFade();
+    applyProgram(program);
+  }
+
+  // Every change of the block is known now, the main input is untouched yet
+  if (capture.isActive()) {
+    capture.captureBlock(getBusBuffer(buffer, true, 0));
+  }
+
+  livePath.enabled = processorEnabled;
+  livePath.frogginess = frogginessSmoother.getNextValue();
+  livePath.outputGain = outputGainSmoother.getNextValue();
+  const auto ramp =
+      morphEnabled ? morphEngine.advance(numSamples) : MorphEngine::Ramp{};
+
+  // The outgoing program works on its own copy of the input. A block larger
+  // than the prepared size cuts the fade short rather than allocate.
+  if (fadeRemaining > 0 && (numSamples > fadeBuffer.getNumSamples() ||
+                            mainBuffer.getNumChannels() >
+                                fadeBuffer.getNumChannels())) {
+    fadeRemaining = 0;
+  }
+  const int fadeChannels = fadeRemaining > 0 ? mainBuffer.getNumChannels() : 0;
+  juce::AudioBuffer<float> outgoing(fadeBuffer.getArrayOfWritePointers(),
+                                    fadeChannels, numSamples);
+  for (int ch = 0; ch < outgoing.getNumChannels(); ++ch) {
+    outgoing.copyFrom(ch, 0, mainBuffer, ch, 0, outgoing.getNumSamples());
+  }
+
+  renderPath(livePath, mainBuffer, ramp, &buffer);
+
+  if (fadeRemaining > 0) {
+    renderPath(fadePath, outgoing, ramp, nullptr);
+    mixProgramFade(mainBuffer, outgoing);
+  }
+}
 
-  if (!processorEnabled) {
+void DynamicsAudioProcessor::renderPath(Path &path,
+                                        juce::AudioBuffer<float> &target,
+                                        const MorphEngine::Ramp &ramp,
+                                        juce::AudioBuffer<float> *stems) {
+  // Without a formant table the processor has not been prepared, or has been
+  // released, so the block passes through dry
+  if (!path.enabled || formantTable == nullptr) {
+    for (int bus = Bus::Band1; bus < Bus::NumOutputs; ++bus) {
+      writeStem(stems, bus, target);
+    }
     return;
   }
 
-  float currentFrogginess = frogginessSmoother.getNextValue();
-  float outputGain = outputGainSmoother.getNextValue();
+  if (morphEnabled) {
+    processMorph(path.chain, target, ramp, path.outputGain, stems);
+    // The morph engine loads its own coefficients into the chain, so the
+    // next static block has to look them up again
+    path.coefficientFrogginess = -1.0f;
+    return;
+  }
 
-  if (currentFrogginess < 0.001f) {
-    buffer.applyGain(outputGain);
+  if (path.frogginess < 0.001f) {
+    for (int bus = Bus::Band1; bus < Bus::NumOutputs; ++bus) {
+      writeStem(stems, bus, target);
+    }
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::OutputGain);
+    target.applyGain(path.outputGain);
     return;
   }
 
   // --- REAL-TIME SAFE PARAMETER UPDATES ---
-  float formantGainDb = juce::jmap(currentFrogginess, 0.0f, 1.0f, 0.0f, 18.0f);
-  float formantQ = juce::jmap(currentFrogginess, 0.0f, 1.0f, 1.0f, 5.0f);
+  // Coefficients are only looked up again once the frogginess has moved
+  if (path.frogginess != path.coefficientFrogginess) {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Coefficients);
+    FormantTable::Bands formantCoefficients;
+    formantTable->lookup(path.frogginess, formantCoefficients);
+    setChainCoefficients(path, formantCoefficients, path.frogginess);
+  }
+  path.chain.get<3>().frogginess = path.frogginess;
 
-  processorChain.get<0>().get<0>().setResonance(formantQ);
-  processorChain.get<0>().get<1>().setGainDecibels(formantGainDb);
+  // --- DSP ---
 
-  processorChain.get<1>().get<0>().setResonance(formantQ);
-  processorChain.get<1>().get<1>().setGainDecibels(formantGainDb);
+  // 1. Process through the formant and shaper chain, one stage at a time so
+  // the stems can be tapped in between
+  juce::dsp::AudioBlock<float> audioBlock(target);
+  juce::dsp::ProcessContextReplacing<float> context(audioBlock);
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Band1);
+    path.chain.get<0>().process(context);
+  }
+  writeStem(stems, Bus::Band1, target);
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Band2);
+    path.chain.get<1>().process(context);
+  }
+  writeStem(stems, Bus::Band2, target);
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Band3);
+    path.chain.get<2>().process(context);
+  }
+  writeStem(stems, Bus::Formant, target);
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Shaper);
+    path.chain.get<3>().process(context);
+  }
+  writeStem(stems, Bus::Shaped, target);
 
-  processorChain.get<2>().get<0>().setResonance(formantQ);
-  processorChain.get<2>().get<1>().setGainDecibels(formantGainDb);
+  // 2. Apply final output gain
+  FROGIFY_PROFILE_STAGE(stageProfiler, Stage::OutputGain);
+  target.applyGain(path.outputGain);
+}
 
-  processorChain.get<3>().frogginess = currentFrogginess;
+void DynamicsAudioProcessor::processMorph(Chain &chain,
+                                          juce::AudioBuffer<float> &target,
+                                          const MorphEngine::Ramp &ramp,
+                                          float outputGain,
+                                          juce::AudioBuffer<float> *stems) {
+  juce::dsp::AudioBlock<float> audioBlock(target);
 
-  // --- DSP ---
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Band1);
+    morphEngine.processBand(0, chain.get<0>(), audioBlock, ramp);
+  }
+  writeStem(stems, Bus::Band1, target);
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Band2);
+    morphEngine.processBand(1, chain.get<1>(), audioBlock, ramp);
+  }
+  writeStem(stems, Bus::Band2, target);
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Band3);
+    morphEngine.processBand(2, chain.get<2>(), audioBlock, ramp);
+  }
+  writeStem(stems, Bus::Formant, target);
+  {
+    FROGIFY_PROFILE_STAGE(stageProfiler, Stage::Shaper);
+    morphEngine.processShaper(audioBlock, ramp);
+  }
+  writeStem(stems, Bus::Shaped, target);
 
-  // 1. Generate LFO data in a block-based, safe way
-  juce::AudioBuffer<float> lfoBuffer(buffer.getNumChannels(),
-                                     buffer.getNumSamples());
-  // lfoBuffer.clear();
-  // juce::dsp::AudioBlock<float> lfoBlock(lfoBuffer);
-  // lfo.process(juce::dsp::ProcessContextReplacing<float>(lfoBlock));
-
-  // 2. Apply LFO as a correct tremolo gain (THE FIX)
-  // This is the stable way to apply the gain modulation.
-  // float lfoDepth = currentFrogginess;
-  // for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
-  //   auto *audioSamples = buffer.getWritePointer(channel);
-  //   auto *lfoSamples = lfoBuffer.getReadPointer(channel);
-  //
-  //   for (int i = 0; i < buffer.getNumSamples(); ++i) {
-  //     // Map LFO from [-1, 1] range to a [0, 1] range
-  //     float lfoValue = (lfoSamples[i] + 1.0f) * 0.5f;
-  //     // Calculate gain, ensuring it's always positive and max 1.0
-  //     float tremoloGain = 1.0f - lfoDepth * lfoValue;
-  //     audioSamples[i] *= tremoloGain;
-  //   }
-  // }
-
-  // 3. Process through the formant and shaper chain
-  juce::dsp::AudioBlock<float> audioBlock(buffer);
-  processorChain.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
-
-  // 4. Apply final output gain
-  buffer.applyGain(outputGain);
-}
-
-void DynamicsAudioProcessor::releaseResources() { processorChain.reset(); }
+  FROGIFY_PROFILE_STAGE(stageProfiler, Stage::OutputGain);
+  morphEngine.processOutputGain(audioBlock, ramp);
+  audioBlock.multiplyBy(outputGain);
+}
+
+void DynamicsAudioProcessor::setChainCoefficients(
+    Path &path, const FormantTable::Bands &bands, float frogginess) {
+  path.chain.get<0>().setCoefficients(bands[0]);
+  path.chain.get<1>().setCoefficients(bands[1]);
+  path.chain.get<2>().setCoefficients(bands[2]);
+  path.coefficientFrogginess = frogginess;
+}
+
+void DynamicsAudioProcessor::startProgramFade() {
+  // Not prepared yet, there is nothing to fade from
+  if (fadeLength <= 0) {
+    return;
+  }
+  // Both chains are prepared for the same channels, so copying the filter
+  // states does not allocate. A change landing during a fade restarts it
+  // from the program currently fading in.
+  fadePath = livePath;
+  fadeRemaining = fadeLength;
+}
+
+void DynamicsAudioProcessor::mixProgramFade(
+    juce::AudioBuffer<float> &mainBuffer,
+    const juce::AudioBuffer<float> &outgoing) {
+  const int count = juce::jmin(mainBuffer.getNumSamples(), fadeRemaining);
+  const int done = fadeLength - fadeRemaining;
+  const float step = 1.0f / static_cast<float>(fadeLength);
+  constexpr float halfPi = juce::MathConstants<float>::halfPi;
+
+  // Equal power, the two programs are mostly uncorrelated
+  for (int ch = 0; ch < mainBuffer.getNumChannels(); ++ch) {
+    auto *incoming = mainBuffer.getWritePointer(ch);
+    const auto *old = outgoing.getReadPointer(ch);
+    for (int i = 0; i < count; ++i) {
+      const float angle = static_cast<float>(done + i + 1) * step * halfPi;
+      incoming[i] = old[i] * std::cos(angle) + incoming[i] * std::sin(angle);
+    }
+  }
+  fadeRemaining -= count;
+}
+
+void DynamicsAudioProcessor::updateMorphSnapshots() {
+  // Slots stay pending until there is a table to resolve them with
+  if (formantTable == nullptr ||
+      pendingMorphSlots.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  const auto pending = pendingMorphSlots.exchange(0);
+  for (size_t slot = 0; slot < MorphEngine::NumSnapshots; ++slot) {
+    if ((pending & (1u << slot)) != 0) {
+      const float froginess = morphSlots[slot].froginess.load();
+      const float outputGainDb = morphSlots[slot].outputGainDb.load();
+      morphEngine.setSnapshot(slot, froginess / 100.0f,
+                              juce::Decibels::decibelsToGain(outputGainDb),
+                              *formantTable);
+      capture.captureMorphSlot(slot, froginess, outputGainDb);
+    }
+  }
+}
+
+void DynamicsAudioProcessor::setMorphSnapshot(size_t slot, MorphSlot values) {
+  if (slot >= MorphEngine::NumSnapshots) {
+    return;
+  }
+  // Values first, a slot flagged while the audio thread reads it is simply
+  // resolved again on the next block
+  morphSlots[slot].froginess.store(juce::jlimit(
+      Param::Ranges::FroginessMin, Param::Ranges::FroginessMax,
+      values.froginess));
+  morphSlots[slot].outputGainDb.store(juce::jlimit(
+      Param::Ranges::OutputGainMin, Param::Ranges::OutputGainMax,
+      values.outputGainDb));
+  pendingMorphSlots.fetch_or(1u << slot);
+}
+
+DynamicsAudioProcessor::MorphSlot
+DynamicsAudioProcessor::getMorphSnapshot(size_t slot) const {
+  if (slot >= MorphEngine::NumSnapshots) {
+    return {};
+  }
+  return {morphSlots[slot].froginess.load(),
+          morphSlots[slot].outputGainDb.load()};
+}
+
+void DynamicsAudioProcessor::storeMorphSnapshot(size_t slot) {
+  auto plainValue = [this](Param::Index index) {
+    auto *param = parameterManager.getParameter(index);
+    return param->convertFrom0to1(param->getValue());
+  };
+  setMorphSnapshot(slot, {plainValue(Param::FroginessLevel),
+                          plainValue(Param::OutputGain)});
+  updateHostDisplay(ChangeDetails().withNonParameterStateChanged(true));
+}
+
+void DynamicsAudioProcessor::recallMorphSnapshot(size_t slot) {
+  const auto values = getMorphSnapshot(slot);
+  auto setPlainValue = [this](Param::Index index, float value) {
+    auto *param = parameterManager.getParameter(index);
+    param->beginChangeGesture();
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+    param->endChangeGesture();
+  };
+  setPlainValue(Param::FroginessLevel, values.froginess);
+  setPlainValue(Param::OutputGain, values.outputGainDb);
+}
+
+// Slots start on the first factory programs
+void DynamicsAudioProcessor::resetMorphSnapshots() {
+  const auto &bank = ProgramBank::getFactoryBank();
+  for (size_t slot = 0; slot < MorphEngine::NumSnapshots; ++slot) {
+    const auto &values =
+        bank[juce::jmin(static_cast<int>(slot), bank.size() - 1)].values;
+    setMorphSnapshot(slot, {values[Param::FroginessLevel],
+                            values[Param::OutputGain]});
+  }
+}
+
+void DynamicsAudioProcessor::applyProgram(int index) {
+  const auto &program = ProgramBank::getFactoryBank()[index];
+  processorEnabled = program.enabled;
+  frogginessSmoother.setCurrentAndTargetValue(program.frogginess);
+  outputGainSmoother.setCurrentAndTargetValue(program.outputGain);
+
+  // The program's exact coefficients, the live chain skips the table lookup
+  // until the frogginess moves again
+  if (programCoefficients != nullptr) {
+    setChainCoefficients(
+        livePath, programCoefficients->bands[static_cast<size_t>(index)],
+        program.frogginess);
+  }
+}
+
+void DynamicsAudioProcessor::writeOverruns() {
+  if (overrunLog == juce::File()) {
+    return;
+  }
+  if (!telemetry.appendOverrunsToFile(overrunLog)) {
+    DBG("Cannot write overruns to " << overrunLog.getFullPathName());
+    overrunLog = juce::File();
+  }
+}
+
+void DynamicsAudioProcessor::timerCallback() {
+  writeOverruns();
+
+  const int program = programToSync.exchange(-1);
+  if (program < 0) {
+    return;
+  }
+
+  // The resulting parameter events carry the values the audio thread has
+  // already applied, so they do not restart any smoothing. Only the
+  // parameters a program owns are touched, the morph setup stays as it is.
+  const auto &values = ProgramBank::getFactoryBank()[program].values;
+  for (const auto i : ProgramBank::OwnedParameters) {
+    if (auto *param = parameterManager.getParameter(i)) {
+      param->setValueNotifyingHost(param->convertTo0to1(values[i]));
+    }
+  }
+}
+
+void DynamicsAudioProcessor::releaseResources() {
+  livePath.chain.reset();
+  fadePath.chain.reset();
+  fadeRemaining = 0;
+  formantTable.reset();
+  programCoefficients.reset();
+}
 
 void DynamicsAudioProcessor::getStateInformation(juce::MemoryBlock &destData) {
   parameterManager.getStateInformation(destData);
+
+  juce::MemoryOutputStream stream(destData, true);
+  for (size_t slot = 0; slot < MorphEngine::NumSnapshots; ++slot) {
+    const auto values = getMorphSnapshot(slot);
+    stream.writeFloat(values.froginess);
+    stream.writeFloat(values.outputGainDb);
+  }
+  stream.writeInt(morphStateVersion);
+  stream.writeInt(morphStateMagic);
 }
 
 void DynamicsAudioProcessor::setStateInformation(const void *data,
                                                  int sizeInBytes) {
-  parameterManager.setStateInformation(data, sizeInBytes);
+  if (data == nullptr || sizeInBytes <= 0) {
+    return;
+  }
+
+  // States saved without morph slots load the default slots
+  const auto *end = static_cast<const char *>(data) + sizeInBytes;
+  if (sizeInBytes < morphStateSize ||
+      juce::ByteOrder::littleEndianInt(end - 4) !=
+          static_cast<juce::uint32>(morphStateMagic) ||
+      juce::ByteOrder::littleEndianInt(end - 8) !=
+          static_cast<juce::uint32>(morphStateVersion)) {
+    parameterManager.setStateInformation(data, sizeInBytes);
+    resetMorphSnapshots();
+    return;
+  }
+
+  parameterManager.setStateInformation(data, sizeInBytes - morphStateSize);
+  juce::MemoryInputStream stream(end - morphStateSize, morphStateSize, false);
+  for (size_t slot = 0; slot < MorphEngine::NumSnapshots; ++slot) {
+    MorphSlot values;
+    values.froginess = stream.readFloat();
+    values.outputGainDb = stream.readFloat();
+    if (std::isfinite(values.froginess) && std::isfinite(values.outputGainDb)) {
+      setMorphSnapshot(slot, values);
+    }
+  }
 }
 
 juce::AudioProcessorEditor *DynamicsAudioProcessor::createEditor() {
@@ -177,10 +595,30 @@ bool DynamicsAudioProcessor::acceptsMidi() const { return false; }
 bool DynamicsAudioProcessor::producesMidi() const { return false; }
 bool DynamicsAudioProcessor::isMidiEffect() const { return false; }
 double DynamicsAudioProcessor::getTailLengthSeconds() const { return 0.0; }
-int DynamicsAudioProcessor::getNumPrograms() { return 1; }
-int DynamicsAudioProcessor::getCurrentProgram() { return 0; }
-void DynamicsAudioProcessor::setCurrentProgram(int) {}
-const juce::String DynamicsAudioProcessor::getProgramName(int) { return {}; }
+int DynamicsAudioProcessor::getNumPrograms() {
+  return ProgramBank::getFactoryBank().size();
+}
+int DynamicsAudioProcessor::getCurrentProgram() {
+  return currentProgram.load();
+}
+// May be called from the audio thread (e.g. VST3 program changes), so this
+// only publishes the index
+void DynamicsAudioProcessor::setCurrentProgram(int index) {
+  if (!juce::isPositiveAndBelow(index, ProgramBank::NumPrograms)) {
+    return;
+  }
+  currentProgram.store(index);
+  pendingProgram.store(index);
+  programToSync.store(index);
+}
+const juce::String DynamicsAudioProcessor::getProgramName(int index) {
+  if (!juce::isPositiveAndBelow(index, ProgramBank::NumPrograms)) {
+    return {};
+  }
+  const auto name = ProgramBank::getFactoryBank()[index].name;
+  return juce::String::fromUTF8(name.data(), static_cast<int>(name.size()));
+}
+// Factory program names are fixed
 void DynamicsAudioProcessor::changeProgramName(int, const juce::String &) {}
 bool DynamicsAudioProcessor::hasEditor() const { return true; }
 
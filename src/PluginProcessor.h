@@ -1,87 +1,66 @@
 #pragma once
 
+#include "BlockTelemetry.h"
+#include "FormantTable.h"
+#include "FrogWaveShaper.h"
+#include "MorphEngine.h"
+#include "Parameters.h"
+#include "ProgramBank.h"
+#include "SessionCapture.h"
+#include "StageProfiler.h"
+
 #include <JuceHeader.h>
 
-// This struct holds our stateful waveshaper logic
-struct FrogWaveShaper {
-  float frogginess = 0.0f;
-  void prepare(const juce::dsp::ProcessSpec &) {}
-  void reset() { frogginess = 0.0f; }
-
-  template <typename ProcessContext>
-  void process(const ProcessContext &context) noexcept {
-    auto &inputBlock = context.getInputBlock();
-    auto &outputBlock = context.getOutputBlock();
-    if (context.isBypassed) {
-      outputBlock.copyFrom(inputBlock);
-      return;
-    }
-    for (size_t ch = 0; ch < outputBlock.getNumChannels(); ++ch) {
-      auto *in = inputBlock.getChannelPointer(ch);
-      auto *out = outputBlock.getChannelPointer(ch);
-      for (size_t i = 0; i < outputBlock.getNumSamples(); ++i) {
-        auto distorted = std::tanh(in[i] * (1.0f + frogginess * 4.0f));
-        out[i] = (in[i] * (1.0f - frogginess)) + (distorted * frogginess);
-      }
-    }
-  }
-};
+// Output buses. The main bus carries the processed signal, every other bus is
+// an optional stem tapped from the same processing pass. The formant bands run
+// in series, so a band stem is the signal after that band and the formant
+// stem is the signal after the last band. Stems are taken before output gain.
+namespace Bus {
+enum Output : int { Main = 0, Dry, Band1, Band2, Formant, Shaped, NumOutputs };
+} // namespace Bus
 
-// Use the StateVariableTPTFilter which is safe for real-time parameter changes
-using Filter = juce::dsp::StateVariableTPTFilter<float>;
-// A FormantBand now contains the safe filter and a gain stage for the boost
-using FormantBand = juce::dsp::ProcessorChain<Filter, juce::dsp::Gain<float>>;
-
-namespace Param {
-namespace ID {
-static const juce::String Enabled{"enabled"};
-static const juce::String OutputGain{"output_gain"};
-static const juce::String FroginessLevel{"froginess_level"};
-} // namespace ID
-
-namespace Name {
-static const juce::String Enabled{"Enabled"};
-static const juce::String OutputGain{"Output gain"};
-static const juce::String FroginessLevel{"Froginess level"};
-} // namespace Name
-
-namespace Ranges {
-static const juce::String EnabledOff{"Off"};
-static const juce::String EnabledOn{"On"};
-static constexpr float OutputGainMin{-24.0f};
-static constexpr float OutputGainMax{6.0f};
-static constexpr float OutputGainInc{0.1f};
-static constexpr float OutputGainSkw{2.0f};
-static constexpr float FroginessMin{0.0f};
-static constexpr float FroginessMax{100.0f};
-static constexpr float FroginessInc{1.0f};
-static constexpr float FroginessSkw{1.0f};
-} // namespace Ranges
-
-namespace Defaults {
-static constexpr bool ProcessorEnabledDefault{true};
-static constexpr float OutputGainDefault{0.0f};
-static constexpr float FroginessDefault{0.0f};
-} // namespace Defaults
-
-namespace Units {
-static const juce::String Percentage{"%"};
-static const juce::String Db{"dB"};
-} // namespace Units
-} // namespace Param
-
-class DynamicsAudioProcessor : public juce::AudioProcessor {
+class DynamicsAudioProcessor : public juce::AudioProcessor,
+                               private juce::Timer {
 public:
+  // Formant bands in series followed by the waveshaper
+  using Chain = juce::dsp::ProcessorChain<FormantBand, FormantBand,
+                                          FormantBand, FrogWaveShaper>;
+
+  // Length of the equal power crossfade between two programs
+  static constexpr double ProgramFadeSeconds = 0.02;
+
+  // Construction only builds the parameters. DSP state, the formant table,
+  // scratch buffers and the timer wait for the first prepareToPlay, so host
+  // plugin scans stay cheap.
   DynamicsAudioProcessor();
   ~DynamicsAudioProcessor() override;
 
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void releaseResources() override;
+  bool isBusesLayoutSupported(const BusesLayout &layouts) const override;
   void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
   void getStateInformation(juce::MemoryBlock &destData) override;
   void setStateInformation(const void *data, int sizeInBytes) override;
 
   mrta::ParameterManager &getParameterManager() { return parameterManager; }
+  BlockTelemetry &getTelemetry() { return telemetry; }
+  // Per-stage timings, only collected when built with FROGIFY_STAGE_PROFILER
+  StageProfiler &getStageProfiler() { return stageProfiler; }
+
+  // Contents of a morph snapshot slot, in parameter units
+  struct MorphSlot {
+    float froginess = Param::Defaults::FroginessDefault;
+    float outputGainDb = Param::Defaults::OutputGainDefault;
+  };
+
+  // Morph snapshot slots, saved with the state. Storing captures the current
+  // Froginess and Output gain into a slot, recalling sets both parameters
+  // back to the slot. While morphing, Output gain still applies on top of
+  // the interpolated snapshot gains, so it acts as a trim. Message thread.
+  void storeMorphSnapshot(size_t slot);
+  void recallMorphSnapshot(size_t slot);
+  void setMorphSnapshot(size_t slot, MorphSlot values);
+  MorphSlot getMorphSnapshot(size_t slot) const;
 
   juce::AudioProcessorEditor *createEditor() override;
   bool hasEditor() const override;
@@ -97,20 +76,103 @@ public:
   void changeProgramName(int index, const juce::String &newName) override;
 
 private:
+  // A chain with the values it runs with for the current block. The live
+  // path follows the parameters, during a program change a copy of it keeps
+  // playing the outgoing program.
+  struct Path {
+    Chain chain;
+    // Frogginess the formant coefficients were last set for
+    float coefficientFrogginess = -1.0f;
+    bool enabled = Param::Defaults::ProcessorEnabledDefault;
+    float frogginess = 0.0f;
+    float outputGain = 1.0f;
+  };
+
+  static BusesProperties createBusesProperties();
+  // The whole block processing, processBlock wraps it with telemetry and
+  // session capture
+  void processAudio(juce::AudioBuffer<float> &buffer);
+  // Processes target in place with one path, writing the stems to stems
+  // unless it is null
+  void renderPath(Path &path, juce::AudioBuffer<float> &target,
+                  const MorphEngine::Ramp &ramp,
+                  juce::AudioBuffer<float> *stems);
+  // Processes target through the morph engine, outputGain is applied on top
+  // of the morph gain
+  void processMorph(Chain &chain, juce::AudioBuffer<float> &target,
+                    const MorphEngine::Ramp &ramp, float outputGain,
+                    juce::AudioBuffer<float> *stems);
+  void setChainCoefficients(Path &path, const FormantTable::Bands &bands,
+                            float frogginess);
+  // Applies a program to the DSP state, audio thread only
+  void applyProgram(int index);
+  // Keeps the live path running as the outgoing program for a crossfade
+  void startProgramFade();
+  // Crossfades the outgoing program into the main bus
+  void mixProgramFade(juce::AudioBuffer<float> &mainBuffer,
+                      const juce::AudioBuffer<float> &outgoing);
+  // Resolves the morph slots changed since the last call into the morph
+  // engine, audio thread or prepareToPlay
+  void updateMorphSnapshots();
+  // Puts the first factory programs back into the morph slots
+  void resetMorphSnapshots();
+  // Pushes the values of a changed program to the parameters, so the host
+  // and the editor follow program changes made on the audio thread, and
+  // writes pending overruns
+  void timerCallback() override;
+  // Appends the overruns drained from the telemetry to overrunLog, message
+  // thread only
+  void writeOverruns();
+  // Copies source into an output stem bus, does nothing if the bus is
+  // disabled or buffer is null
+  void writeStem(juce::AudioBuffer<float> *buffer, int busIndex,
+                 const juce::AudioBuffer<float> &source);
+  // Plain values of every parameter as the host last set them
+  SessionCapture::Values getParameterValues();
+
   mrta::ParameterManager parameterManager;
   double currentSampleRate = 0;
 
   // DSP Objects
-  juce::dsp::Oscillator<float> lfo;
-  juce::dsp::ProcessorChain<FormantBand, FormantBand, FormantBand,
-                            FrogWaveShaper>
-      processorChain;
+  std::shared_ptr<const FormantTable> formantTable;
+  std::shared_ptr<const ProgramBank::Coefficients> programCoefficients;
+  Path livePath;
+
+  // Program crossfade, the outgoing path and its input copy
+  Path fadePath;
+  juce::AudioBuffer<float> fadeBuffer;
+  int fadeLength = 0;
+  int fadeRemaining = 0;
+
+  MorphEngine morphEngine;
+  // Slot values are written by the message thread, the audio thread picks
+  // up the slots flagged in pendingMorphSlots
+  struct SharedMorphSlot {
+    std::atomic<float> froginess{Param::Defaults::FroginessDefault};
+    std::atomic<float> outputGainDb{Param::Defaults::OutputGainDefault};
+  };
+  std::array<SharedMorphSlot, MorphEngine::NumSnapshots> morphSlots;
+  std::atomic<uint32_t> pendingMorphSlots{0};
+  BlockTelemetry telemetry;
+  StageProfiler stageProfiler;
+  bool diagnosticsStarted = false;
+  bool tracing = false;
+  // Set from FROGIFY_OVERRUNS, empty when overruns are not written
+  juce::File overrunLog;
+  SessionCapture capture;
 
   // Parameters
   bool processorEnabled = Param::Defaults::ProcessorEnabledDefault;
+  bool morphEnabled = Param::Defaults::MorphEnabledDefault;
   juce::SmoothedValue<float> frogginessSmoother;
   juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>
       outputGainSmoother;
 
+  // Programs, a change is applied by the audio thread on the next block and
+  // its own parameters are mirrored by the timer on the message thread
+  std::atomic<int> currentProgram{0};
+  std::atomic<int> pendingProgram{-1};
+  std::atomic<int> programToSync{-1};
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DynamicsAudioProcessor)
 };
@@ -0,0 +1,59 @@
+#include "ProgramBank.h"
+
+namespace {
+
+// Program names live in Param::Ranges::ProgramNames, in the same order
+struct PresetDescriptor {
+  bool enabled;
+  float outputGainDb;
+  float froginessPercent;
+};
+
+constexpr std::array<PresetDescriptor, ProgramBank::NumPrograms> Presets{{
+    {true, 0.0f, 0.0f},
+    {true, 0.0f, 25.0f},
+    {true, -3.0f, 50.0f},
+    {true, -6.0f, 80.0f},
+    {true, -9.0f, 100.0f},
+}};
+
+} // namespace
+
+ProgramBank::ProgramBank() {
+  for (size_t i = 0; i < programs.size(); ++i) {
+    const auto &preset = Presets[i];
+    auto &program = programs[i];
+
+    // Parameters a preset does not set keep their defaults
+    program.name = Param::Ranges::ProgramNames[i];
+    for (size_t p = 0; p < program.values.size(); ++p) {
+      program.values[p] = Param::Descriptors[p].def;
+    }
+    program.values[Param::Enabled] = preset.enabled ? 1.0f : 0.0f;
+    program.values[Param::OutputGain] = preset.outputGainDb;
+    program.values[Param::FroginessLevel] = preset.froginessPercent;
+
+    program.enabled = preset.enabled;
+    program.frogginess = preset.froginessPercent / 100.0f;
+    program.outputGain = juce::Decibels::decibelsToGain(preset.outputGainDb);
+  }
+}
+
+const ProgramBank &ProgramBank::getFactoryBank() {
+  static const ProgramBank bank;
+  return bank;
+}
+
+std::shared_ptr<const ProgramBank::Coefficients>
+ProgramBank::getSharedCoefficients(double sampleRate) {
+  return mrta::SharedResourceCache::getInstance().get<Coefficients>(
+      sampleRate, NumPrograms, [](double rate, int) {
+        auto coefficients = std::make_shared<Coefficients>();
+        const auto &bank = getFactoryBank();
+        for (int i = 0; i < NumPrograms; ++i) {
+          coefficients->bands[static_cast<size_t>(i)] =
+              FormantTable::compute(rate, bank[i].frogginess);
+        }
+        return coefficients;
+      });
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "FormantTable.h"
+#include "Parameters.h"
+
+#include <array>
+#include <memory>
+#include <string_view>
+
+// Factory programs. Every program is stored as a compact vector of parameter
+// values plus the derived values the audio thread needs, so a program change
+// is a handful of stores with no allocation and no conversion. Formant
+// coefficients depend on the sample rate, so they live in a separate table
+// per rate, shared by all instances like FormantTable.
+class ProgramBank {
+public:
+  // Parameters a program sets. Everything else, the morph setup included,
+  // belongs to the user and is left alone by a program change.
+  static constexpr std::array<Param::Index, 3> OwnedParameters{
+      Param::Enabled, Param::OutputGain, Param::FroginessLevel};
+
+  struct Program {
+    std::string_view name;
+    // Values in parameter units, indexed by Param::Index
+    std::array<float, Param::Count> values{};
+
+    // Derived values, same mapping as the parameter callbacks
+    bool enabled = true;
+    float frogginess = 0.0f;
+    float outputGain = 1.0f;
+  };
+
+  static constexpr int NumPrograms =
+      static_cast<int>(Param::Ranges::ProgramNames.size());
+
+  // Exact formant coefficients of every program at one sample rate
+  struct Coefficients {
+    std::array<FormantTable::Bands, NumPrograms> bands;
+  };
+
+  // The bank is built once per process, on first use
+  static const ProgramBank &getFactoryBank();
+
+  // Get the coefficients shared by all instances, builds them if needed.
+  // Not real-time safe, call from prepareToPlay.
+  static std::shared_ptr<const Coefficients>
+  getSharedCoefficients(double sampleRate);
+
+  int size() const noexcept { return NumPrograms; }
+  const Program &operator[](int index) const noexcept {
+    return programs[static_cast<size_t>(index)];
+  }
+
+private:
+  ProgramBank();
+
+  std::array<Program, NumPrograms> programs;
+};
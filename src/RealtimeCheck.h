@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+// Real-time safety instrumentation. When FROGIFY_RTCHECK is defined (only by
+// the frogify_rtcheck tool), the allocator and mutex functions are interposed
+// and every call made inside a region marked with FROGIFY_REALTIME_SCOPE is
+// reported with a stack trace. Otherwise the macro compiles to nothing.
+#if defined(FROGIFY_RTCHECK) && FROGIFY_RTCHECK
+
+namespace rtcheck {
+
+void enterRealtimeRegion() noexcept;
+void leaveRealtimeRegion() noexcept;
+
+// Total number of reported calls since startup
+uint64_t getNumViolations() noexcept;
+// Abort on the first violation, useful under a debugger
+void setAbortOnViolation(bool shouldAbort) noexcept;
+
+struct ScopedRealtimeRegion {
+  ScopedRealtimeRegion() noexcept { enterRealtimeRegion(); }
+  ~ScopedRealtimeRegion() noexcept { leaveRealtimeRegion(); }
+  ScopedRealtimeRegion(const ScopedRealtimeRegion &) = delete;
+  ScopedRealtimeRegion &operator=(const ScopedRealtimeRegion &) = delete;
+};
+
+} // namespace rtcheck
+
+#define FROGIFY_REALTIME_SCOPE()                                              \
+  rtcheck::ScopedRealtimeRegion frogifyRealtimeRegion
+
+#else
+
+#define FROGIFY_REALTIME_SCOPE()
+
+#endif
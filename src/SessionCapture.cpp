@@ -0,0 +1,253 @@
+#include "SessionCapture.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+std::atomic<bool> environmentCaptureAllowed{true};
+std::atomic<bool> environmentCaptureRunning{false};
+} // namespace
+
+// Copies a record into the two regions of a ring write
+class SessionCapture::RingWriter {
+public:
+  RingWriter(uint8_t *ringData, const juce::AbstractFifo::ScopedWrite &scope)
+      : data(ringData), start1(scope.startIndex1), size1(scope.blockSize1),
+        start2(scope.startIndex2) {}
+
+  template <typename T> void put(const T &value) noexcept {
+    static_assert(std::is_trivially_copyable<T>::value);
+    putBytes(&value, sizeof(T));
+  }
+
+  void putBytes(const void *source, size_t size) noexcept {
+    const auto *bytes = static_cast<const uint8_t *>(source);
+    while (size > 0) {
+      const int remaining1 = size1 - position;
+      const size_t chunk =
+          remaining1 > 0 ? std::min(size, static_cast<size_t>(remaining1))
+                         : size;
+      uint8_t *destination =
+          remaining1 > 0 ? data + start1 + position
+                         : data + start2 + (position - size1);
+      std::memcpy(destination, bytes, chunk);
+      bytes += chunk;
+      position += static_cast<int>(chunk);
+      size -= chunk;
+    }
+  }
+
+private:
+  uint8_t *data;
+  int start1, size1, start2;
+  int position = 0;
+};
+
+SessionCapture::SessionCapture() : juce::Thread("Session capture writer") {}
+
+SessionCapture::~SessionCapture() { stop(); }
+
+bool SessionCapture::start(const juce::File &file) {
+  if (isActive()) {
+    return false;
+  }
+
+  auto stream = std::make_unique<juce::FileOutputStream>(file);
+  if (!stream->openedOk()) {
+    return false;
+  }
+  stream->setPosition(0);
+  stream->truncate();
+  stream->writeInt(static_cast<int>(SessionFormat::Magic));
+  stream->writeInt(static_cast<int>(SessionFormat::Version));
+  stream->writeInt(static_cast<int>(Param::Count));
+  stream->writeInt(static_cast<int>(MorphEngine::NumSnapshots));
+
+  output = std::move(stream);
+  ring.allocate(static_cast<size_t>(RingBytes), false);
+  fifo.reset();
+  pendingParameters.fill(false);
+  pendingSlots.fill(false);
+  pendingProgram = -1;
+  afterGap = false;
+
+  active.store(true, std::memory_order_release);
+  startThread();
+  return true;
+}
+
+bool SessionCapture::startFromEnvironment(const char *variableName) {
+  if (!environmentCaptureAllowed.load()) {
+    return false;
+  }
+  const auto path = juce::SystemStats::getEnvironmentVariable(variableName, {});
+  if (path.isEmpty() || environmentCaptureRunning.exchange(true)) {
+    return false;
+  }
+  fromEnvironment = start(juce::File::getCurrentWorkingDirectory()
+                              .getChildFile(path)
+                              .getNonexistentSibling());
+  if (!fromEnvironment) {
+    environmentCaptureRunning.store(false);
+  }
+  return fromEnvironment;
+}
+
+void SessionCapture::setEnvironmentCaptureAllowed(bool allowed) noexcept {
+  environmentCaptureAllowed.store(allowed);
+}
+
+void SessionCapture::stop() {
+  if (!isActive()) {
+    return;
+  }
+  active.store(false, std::memory_order_release);
+  stopThread(2000);
+  drain();
+  output->flush();
+  output.reset();
+  if (fromEnvironment) {
+    fromEnvironment = false;
+    environmentCaptureRunning.store(false);
+  }
+}
+
+void SessionCapture::capturePrepare(double sampleRate, int maxBlockSize,
+                                    int numChannels, const Values &values,
+                                    const MorphSlots &slots) noexcept {
+  if (!isActive()) {
+    return;
+  }
+
+  // The prepare record holds the whole state, nothing is pending after it
+  pendingParameters.fill(false);
+  pendingSlots.fill(false);
+  pendingProgram = -1;
+
+  const int size =
+      static_cast<int>(sizeof(uint8_t) + sizeof(double) + 2 * sizeof(int32_t) +
+                       sizeof(Values) + sizeof(MorphSlots));
+  if (fifo.getFreeSpace() < size) {
+    afterGap = true;
+    return;
+  }
+
+  auto scope = fifo.write(size);
+  RingWriter writer(ring.get(), scope);
+  writer.put(static_cast<uint8_t>(SessionFormat::Prepare));
+  writer.put(sampleRate);
+  writer.put(static_cast<int32_t>(maxBlockSize));
+  writer.put(static_cast<int32_t>(numChannels));
+  writer.put(values);
+  writer.put(slots);
+}
+
+void SessionCapture::captureParameter(uint32_t index, float value) noexcept {
+  if (!isActive() || index >= Param::Count) {
+    return;
+  }
+  pendingValues[index] = value;
+  pendingParameters[index] = true;
+}
+
+void SessionCapture::captureMorphSlot(size_t slot, float froginess,
+                                      float outputGainDb) noexcept {
+  if (!isActive() || slot >= MorphEngine::NumSnapshots) {
+    return;
+  }
+  pendingSlotValues[slot] = {froginess, outputGainDb};
+  pendingSlots[slot] = true;
+}
+
+void SessionCapture::captureProgram(int program) noexcept {
+  if (!isActive() || program < 0) {
+    return;
+  }
+  pendingProgram = program;
+}
+
+void SessionCapture::captureBlock(
+    const juce::AudioBuffer<float> &input) noexcept {
+  if (!isActive()) {
+    return;
+  }
+
+  const auto numChanged = static_cast<size_t>(
+      std::count(pendingParameters.begin(), pendingParameters.end(), true));
+  const auto numSlots = static_cast<size_t>(
+      std::count(pendingSlots.begin(), pendingSlots.end(), true));
+
+  const int numChannels = input.getNumChannels();
+  const int numSamples = input.getNumSamples();
+  const size_t headerSize = sizeof(uint8_t) + 2 * sizeof(int32_t) +
+                            sizeof(uint8_t) + sizeof(int32_t) +
+                            sizeof(uint16_t);
+  const size_t eventsSize = numChanged * (sizeof(uint16_t) + sizeof(float));
+  const size_t slotsSize =
+      sizeof(uint8_t) + numSlots * (sizeof(uint8_t) + 2 * sizeof(float));
+  const size_t audioSize = static_cast<size_t>(numChannels) *
+                           static_cast<size_t>(numSamples) * sizeof(float);
+  const int size =
+      static_cast<int>(headerSize + eventsSize + slotsSize + audioSize);
+
+  // Changes stay pending, so the next captured block carries them
+  if (fifo.getFreeSpace() < size) {
+    numDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+    afterGap = true;
+    return;
+  }
+
+  auto scope = fifo.write(size);
+  RingWriter writer(ring.get(), scope);
+  writer.put(static_cast<uint8_t>(SessionFormat::Block));
+  writer.put(static_cast<int32_t>(numSamples));
+  writer.put(static_cast<int32_t>(numChannels));
+  writer.put(static_cast<uint8_t>(afterGap ? SessionFormat::AfterGapFlag : 0));
+  writer.put(static_cast<int32_t>(pendingProgram));
+  writer.put(static_cast<uint16_t>(numChanged));
+  for (size_t i = 0; i < pendingParameters.size(); ++i) {
+    if (pendingParameters[i]) {
+      writer.put(static_cast<uint16_t>(i));
+      writer.put(pendingValues[i]);
+    }
+  }
+  writer.put(static_cast<uint8_t>(numSlots));
+  for (size_t slot = 0; slot < pendingSlots.size(); ++slot) {
+    if (pendingSlots[slot]) {
+      writer.put(static_cast<uint8_t>(slot));
+      writer.put(pendingSlotValues[slot]);
+    }
+  }
+  for (int ch = 0; ch < numChannels; ++ch) {
+    writer.putBytes(input.getReadPointer(ch),
+                    static_cast<size_t>(numSamples) * sizeof(float));
+  }
+
+  pendingParameters.fill(false);
+  pendingSlots.fill(false);
+  pendingProgram = -1;
+  afterGap = false;
+}
+
+void SessionCapture::run() {
+  while (!threadShouldExit()) {
+    wait(20);
+    drain();
+  }
+}
+
+void SessionCapture::drain() {
+  const int numReady = fifo.getNumReady();
+  if (numReady == 0) {
+    return;
+  }
+  auto scope = fifo.read(numReady);
+  if (scope.blockSize1 > 0) {
+    output->write(ring.get() + scope.startIndex1,
+                  static_cast<size_t>(scope.blockSize1));
+  }
+  if (scope.blockSize2 > 0) {
+    output->write(ring.get() + scope.startIndex2,
+                  static_cast<size_t>(scope.blockSize2));
+  }
+}
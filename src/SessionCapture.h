@@ -0,0 +1,108 @@
+#pragma once
+
+#include "MorphEngine.h"
+#include "Parameters.h"
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Session capture file format, little endian:
+//   header:  magic "FRGC", uint32 version, uint32 number of parameters,
+//            uint32 number of morph slots
+//   records: uint8 record type followed by its payload
+//   Prepare: float64 sample rate, int32 max block size, int32 channels,
+//            float32 plain value of every parameter, float32 froginess and
+//            output gain in dB of every morph slot
+//   Block:   int32 samples, int32 channels, uint8 flags, int32 program
+//            (-1 if none), uint16 event count, events as uint16 parameter
+//            index and float32 plain value, uint8 morph slot count, slots
+//            as uint8 index, float32 froginess and output gain in dB, then
+//            the float32 input samples channel after channel
+namespace SessionFormat {
+inline constexpr uint32_t Magic = 0x43475246; // "FRGC"
+inline constexpr uint32_t Version = 2;
+enum RecordType : uint8_t { Prepare = 1, Block = 2 };
+// The ring was full before this block, some blocks were not captured
+inline constexpr uint8_t AfterGapFlag = 1;
+} // namespace SessionFormat
+
+// Records everything needed to replay a session deterministically: sample
+// rate and block sizes, the input audio of the main bus and every parameter,
+// morph slot or program change, with block granularity. Changes are the ones
+// the processor actually applied in a block, reported while it applies them.
+// The audio thread serialises each block into a preallocated lock-free byte
+// ring and a background thread writes the ring to disk. Blocks which do not
+// fit are dropped whole and the next one is flagged, changes of dropped
+// blocks carry over to it.
+class SessionCapture : private juce::Thread {
+public:
+  static constexpr int RingBytes = 1 << 22;
+  using Values = std::array<float, Param::Count>;
+  // Froginess and output gain in dB of every morph slot
+  using MorphSlots =
+      std::array<std::array<float, 2>, MorphEngine::NumSnapshots>;
+
+  SessionCapture();
+  ~SessionCapture() override;
+
+  // Opens the file, allocates the ring and starts the writer thread.
+  // Not real-time safe.
+  bool start(const juce::File &file);
+  // Starts capturing if the environment variable names a file. Only one
+  // capture per process runs from the environment at a time, it writes to
+  // a new file next to the given name.
+  bool startFromEnvironment(const char *variableName);
+  // Headless tools turn this off before creating processors, so a variable
+  // set for a host session does not also record the tool's own runs
+  static void setEnvironmentCaptureAllowed(bool allowed) noexcept;
+  void stop();
+
+  bool isActive() const noexcept {
+    return active.load(std::memory_order_acquire);
+  }
+
+  // From prepareToPlay, after the parameters have been applied
+  void capturePrepare(double sampleRate, int maxBlockSize, int numChannels,
+                      const Values &values, const MorphSlots &slots) noexcept;
+
+  // Audio thread, changes the next captured block applies
+  void captureParameter(uint32_t index, float value) noexcept;
+  void captureMorphSlot(size_t slot, float froginess,
+                        float outputGainDb) noexcept;
+  void captureProgram(int program) noexcept;
+
+  // Audio thread, once the block has applied its changes and before it
+  // processes the input
+  void captureBlock(const juce::AudioBuffer<float> &input) noexcept;
+
+  uint64_t getNumDroppedBlocks() const noexcept {
+    return numDroppedBlocks.load();
+  }
+
+private:
+  class RingWriter;
+
+  void run() override;
+  void drain();
+
+  std::atomic<bool> active{false};
+  std::atomic<uint64_t> numDroppedBlocks{0};
+
+  juce::AbstractFifo fifo{RingBytes};
+  juce::HeapBlock<uint8_t> ring;
+  std::unique_ptr<juce::FileOutputStream> output;
+  // This capture holds the process wide environment capture slot
+  bool fromEnvironment = false;
+
+  // Audio thread state, changes not written yet
+  Values pendingValues{};
+  std::array<bool, Param::Count> pendingParameters{};
+  MorphSlots pendingSlotValues{};
+  std::array<bool, MorphEngine::NumSnapshots> pendingSlots{};
+  int pendingProgram = -1;
+  bool afterGap = false;
+
+  JUCE_DECLARE_NON_COPYABLE(SessionCapture)
+};
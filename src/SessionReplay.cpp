@@ -0,0 +1,204 @@
+#include "SessionReplay.h"
+
+SessionReplay::SessionReplay(const juce::File &file) {
+  juce::FileInputStream stream(file);
+  if (!stream.openedOk()) {
+    error = "Cannot open " + file.getFullPathName();
+    return;
+  }
+  if (!load(stream)) {
+    records.clear();
+  }
+}
+
+double SessionReplay::getSampleRate() const {
+  for (const auto &record : records) {
+    if (record.type == SessionFormat::Prepare) {
+      return record.sampleRate;
+    }
+  }
+  return 0.0;
+}
+
+int SessionReplay::getNumChannels() const {
+  for (const auto &record : records) {
+    if (record.type == SessionFormat::Prepare) {
+      return record.numChannels;
+    }
+  }
+  return 0;
+}
+
+bool SessionReplay::load(juce::InputStream &stream) {
+  if (static_cast<uint32_t>(stream.readInt()) != SessionFormat::Magic) {
+    error = "Not a session capture";
+    return false;
+  }
+  if (static_cast<uint32_t>(stream.readInt()) != SessionFormat::Version) {
+    error = "Unsupported session capture version";
+    return false;
+  }
+  if (stream.readInt() != static_cast<int>(Param::Count) ||
+      stream.readInt() != static_cast<int>(MorphEngine::NumSnapshots)) {
+    error = "Session was captured with a different parameter set";
+    return false;
+  }
+
+  double sampleRate = 0.0;
+  // The writer may have been stopped in the middle of a record, a truncated
+  // tail is ignored
+  while (!stream.isExhausted()) {
+    Record record;
+    const auto type = static_cast<uint8_t>(stream.readByte());
+
+    if (type == SessionFormat::Prepare) {
+      if (stream.getNumBytesRemaining() <
+          static_cast<juce::int64>(sizeof(double) + 2 * sizeof(int32_t) +
+                                   sizeof(SessionCapture::Values) +
+                                   sizeof(SessionCapture::MorphSlots))) {
+        break;
+      }
+      record.type = SessionFormat::Prepare;
+      record.sampleRate = stream.readDouble();
+      record.maxBlockSize = stream.readInt();
+      record.numChannels = stream.readInt();
+      for (auto &value : record.values) {
+        value = stream.readFloat();
+      }
+      for (auto &slot : record.slots) {
+        slot[0] = stream.readFloat();
+        slot[1] = stream.readFloat();
+      }
+      if (record.sampleRate <= 0.0 || record.maxBlockSize <= 0 ||
+          record.numChannels <= 0) {
+        error = "Corrupt prepare record";
+        return false;
+      }
+      sampleRate = record.sampleRate;
+    } else if (type == SessionFormat::Block) {
+      // Samples, channels, flags, program and event count
+      if (stream.getNumBytesRemaining() < 15) {
+        break;
+      }
+      record.type = SessionFormat::Block;
+      const int numSamples = stream.readInt();
+      record.numChannels = stream.readInt();
+      record.afterGap = (stream.readByte() & SessionFormat::AfterGapFlag) != 0;
+      record.program = stream.readInt();
+      const int numEvents = static_cast<uint16_t>(stream.readShort());
+      if (sampleRate <= 0.0 || numSamples < 0 || record.numChannels < 0 ||
+          numEvents > static_cast<int>(Param::Count)) {
+        error = "Corrupt block record";
+        return false;
+      }
+
+      // Parameter index and value per event
+      if (stream.getNumBytesRemaining() < numEvents * 6) {
+        break;
+      }
+      for (int i = 0; i < numEvents; ++i) {
+        Event event;
+        event.index = static_cast<uint16_t>(stream.readShort());
+        event.value = stream.readFloat();
+        if (event.index >= Param::Count) {
+          error = "Corrupt parameter event";
+          return false;
+        }
+        record.events.push_back(event);
+      }
+
+      // Slot count, then slot index, froginess and output gain per change
+      if (stream.getNumBytesRemaining() < 1) {
+        break;
+      }
+      const int numSlots = static_cast<uint8_t>(stream.readByte());
+      if (numSlots > static_cast<int>(MorphEngine::NumSnapshots)) {
+        error = "Corrupt block record";
+        return false;
+      }
+      if (stream.getNumBytesRemaining() < numSlots * 9) {
+        break;
+      }
+      for (int i = 0; i < numSlots; ++i) {
+        SlotChange change;
+        change.slot = static_cast<uint8_t>(stream.readByte());
+        change.froginess = stream.readFloat();
+        change.outputGainDb = stream.readFloat();
+        if (change.slot >= MorphEngine::NumSnapshots) {
+          error = "Corrupt morph slot change";
+          return false;
+        }
+        record.slotChanges.push_back(change);
+      }
+
+      const auto bytesPerChannel =
+          static_cast<size_t>(numSamples) * sizeof(float);
+      record.input.setSize(record.numChannels, numSamples);
+      bool complete = true;
+      for (int ch = 0; ch < record.numChannels && complete; ++ch) {
+        complete = stream.read(record.input.getWritePointer(ch),
+                               static_cast<int>(bytesPerChannel)) ==
+                   static_cast<int>(bytesPerChannel);
+      }
+      if (!complete) {
+        break;
+      }
+
+      ++numBlocks;
+      numGaps += record.afterGap ? 1 : 0;
+      numFrames += numSamples;
+      durationSeconds += numSamples / sampleRate;
+    } else {
+      error = "Unknown record type " + juce::String(type);
+      return false;
+    }
+
+    records.push_back(std::move(record));
+  }
+
+  if (numBlocks == 0) {
+    error = "Session capture holds no blocks";
+    return false;
+  }
+  return true;
+}
+
+void SessionReplay::prepare(DynamicsAudioProcessor &processor,
+                            const Record &record) {
+  const auto channelSet = record.numChannels == 1
+                              ? juce::AudioChannelSet::mono()
+                              : juce::AudioChannelSet::stereo();
+  auto layout = processor.getBusesLayout();
+  layout.getChannelSet(true, 0) = channelSet;
+  layout.getChannelSet(false, Bus::Main) = channelSet;
+  processor.setBusesLayout(layout);
+
+  auto &manager = processor.getParameterManager();
+  for (uint32_t i = 0; i < Param::Count; ++i) {
+    auto *param = manager.getParameter(i);
+    param->setValueNotifyingHost(param->convertTo0to1(record.values[i]));
+  }
+  for (size_t slot = 0; slot < record.slots.size(); ++slot) {
+    processor.setMorphSnapshot(
+        slot, {record.slots[slot][0], record.slots[slot][1]});
+  }
+  processor.prepareToPlay(record.sampleRate, record.maxBlockSize);
+}
+
+// Changes land in the parameter queue and the pending slots, the next
+// processBlock applies them exactly like it did while capturing
+void SessionReplay::applyChanges(DynamicsAudioProcessor &processor,
+                                 const Record &record) {
+  auto &manager = processor.getParameterManager();
+  for (const auto &event : record.events) {
+    auto *param = manager.getParameter(event.index);
+    param->setValueNotifyingHost(param->convertTo0to1(event.value));
+  }
+  for (const auto &change : record.slotChanges) {
+    processor.setMorphSnapshot(change.slot,
+                               {change.froginess, change.outputGainDb});
+  }
+  if (record.program >= 0) {
+    processor.setCurrentProgram(record.program);
+  }
+}
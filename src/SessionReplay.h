@@ -0,0 +1,117 @@
+#pragma once
+
+#include "PluginProcessor.h"
+#include "SessionCapture.h"
+
+#include <JuceHeader.h>
+#include <chrono>
+#include <vector>
+
+// A captured session, loaded into memory up front so replay timing never
+// includes disk reads, and fed block by block through a processor. The
+// processor sees the captured sample rates, block sizes, input and
+// parameter, morph slot and program changes in the same blocks, so every
+// replay of a file produces the same output.
+class SessionReplay {
+public:
+  struct Event {
+    uint32_t index;
+    float value;
+  };
+
+  struct SlotChange {
+    size_t slot;
+    float froginess;
+    float outputGainDb;
+  };
+
+  struct Record {
+    SessionFormat::RecordType type = SessionFormat::Block;
+    // Prepare
+    double sampleRate = 0.0;
+    int maxBlockSize = 0;
+    SessionCapture::Values values{};
+    SessionCapture::MorphSlots slots{};
+    // Block
+    bool afterGap = false;
+    int program = -1;
+    std::vector<Event> events;
+    std::vector<SlotChange> slotChanges;
+    juce::AudioBuffer<float> input;
+    // Both
+    int numChannels = 0;
+  };
+
+  explicit SessionReplay(const juce::File &file);
+
+  bool isValid() const { return error.isEmpty(); }
+  const juce::String &getError() const { return error; }
+
+  int getNumBlocks() const { return numBlocks; }
+  int getNumGaps() const { return numGaps; }
+  juce::int64 getNumFrames() const { return numFrames; }
+  // Captured audio length, in seconds of its own sample rates
+  double getDurationSeconds() const { return durationSeconds; }
+  // Sample rate and main bus channels of the first prepare
+  double getSampleRate() const;
+  int getNumChannels() const;
+
+  // Runs the whole session through the processor, preparing it from the
+  // captured records. onBlock(blockIndex, mainBuffer, nanoseconds) is called
+  // after every processed block with the main output and the time spent in
+  // processBlock.
+  template <typename OnBlock>
+  void run(DynamicsAudioProcessor &processor, OnBlock &&onBlock) const {
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    int blockIndex = 0;
+
+    for (const auto &record : records) {
+      if (record.type == SessionFormat::Prepare) {
+        prepare(processor, record);
+        buffer.setSize(juce::jmax(processor.getTotalNumInputChannels(),
+                                  processor.getTotalNumOutputChannels()),
+                       record.maxBlockSize);
+        continue;
+      }
+
+      applyChanges(processor, record);
+
+      const int numSamples = record.input.getNumSamples();
+      if (numSamples > buffer.getNumSamples()) {
+        buffer.setSize(buffer.getNumChannels(), numSamples, false, false,
+                       true);
+      }
+      juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(),
+                                     buffer.getNumChannels(), numSamples);
+      block.clear();
+      const int numInputs =
+          juce::jmin(record.numChannels, block.getNumChannels());
+      for (int ch = 0; ch < numInputs; ++ch) {
+        block.copyFrom(ch, 0, record.input, ch, 0, numSamples);
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      processor.processBlock(block, midi);
+      const auto end = std::chrono::steady_clock::now();
+
+      auto mainBuffer = processor.getBusBuffer(block, false, Bus::Main);
+      onBlock(blockIndex++, static_cast<const juce::AudioBuffer<float> &>(
+                                mainBuffer),
+              std::chrono::duration<double, std::nano>(end - start).count());
+    }
+  }
+
+private:
+  bool load(juce::InputStream &stream);
+  static void prepare(DynamicsAudioProcessor &processor, const Record &record);
+  static void applyChanges(DynamicsAudioProcessor &processor,
+                           const Record &record);
+
+  std::vector<Record> records;
+  juce::String error;
+  int numBlocks = 0;
+  int numGaps = 0;
+  juce::int64 numFrames = 0;
+  double durationSeconds = 0.0;
+};
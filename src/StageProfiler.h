@@ -0,0 +1,119 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+// Per-stage timing of processBlock. Stages are timed with ScopedStageTimer
+// through FROGIFY_PROFILE_STAGE, whose timer compiles to nothing unless the
+// FROGIFY_STAGE_PROFILER CMake option is on, so shipping builds pay nothing.
+// Stems are counted per stem written, every other stage once per block.
+// Every stage is also a trace scope, which only exists in builds with the
+// FROGIFY_TRACING CMake option.
+#if defined(FROGIFY_STAGE_PROFILER) && FROGIFY_STAGE_PROFILER
+#define FROGIFY_PROFILE_STAGE(profiler, stage)                                \
+  MRTA_TRACE_SCOPE(Stage::Names[stage].data(), "audio");                      \
+  ScopedStageTimer<> JUCE_JOIN_MACRO(stageTimer, __LINE__)(profiler, stage)
+#else
+#define FROGIFY_PROFILE_STAGE(profiler, stage)                                \
+  MRTA_TRACE_SCOPE(Stage::Names[stage].data(), "audio")
+#endif
+
+namespace Stage {
+enum Id : int {
+  ParameterUpdate = 0,
+  Coefficients,
+  Band1,
+  Band2,
+  Band3,
+  Shaper,
+  OutputGain,
+  Stems,
+  Count
+};
+
+inline constexpr std::array<std::string_view, Count> Names{
+    "Parameters", "Coefficients", "Band 1", "Band 2",
+    "Band 3",     "Shaper",       "Output gain", "Stems"};
+} // namespace Stage
+
+// Lock-free per-stage counters. The audio thread adds to them, any other
+// thread may read or reset them.
+class StageProfiler {
+public:
+#if defined(FROGIFY_STAGE_PROFILER) && FROGIFY_STAGE_PROFILER
+  static constexpr bool Enabled = true;
+#else
+  static constexpr bool Enabled = false;
+#endif
+
+  struct Counters {
+    uint64_t calls = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+
+    double getMeanNs() const noexcept {
+      return calls > 0 ? static_cast<double>(totalNs) / calls : 0.0;
+    }
+  };
+
+  // Audio thread
+  void add(Stage::Id stage, uint64_t nanoseconds) noexcept {
+    auto &slot = slots[static_cast<size_t>(stage)];
+    slot.calls.fetch_add(1, std::memory_order_relaxed);
+    slot.totalNs.fetch_add(nanoseconds, std::memory_order_relaxed);
+    // The audio thread is the only writer, so no compare and swap is needed
+    if (nanoseconds > slot.maxNs.load(std::memory_order_relaxed)) {
+      slot.maxNs.store(nanoseconds, std::memory_order_relaxed);
+    }
+  }
+
+  Counters getCounters(Stage::Id stage) const noexcept {
+    const auto &slot = slots[static_cast<size_t>(stage)];
+    return {slot.calls.load(std::memory_order_relaxed),
+            slot.totalNs.load(std::memory_order_relaxed),
+            slot.maxNs.load(std::memory_order_relaxed)};
+  }
+
+  // A reset racing with the audio thread may keep one sample of the old run
+  void reset() noexcept {
+    for (auto &slot : slots) {
+      slot.calls.store(0, std::memory_order_relaxed);
+      slot.totalNs.store(0, std::memory_order_relaxed);
+      slot.maxNs.store(0, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> totalNs{0};
+    std::atomic<uint64_t> maxNs{0};
+  };
+
+  std::array<Slot, Stage::Count> slots;
+};
+
+// Adds its own lifetime to one stage of a StageProfiler
+template <typename Clock = std::chrono::steady_clock> class ScopedStageTimer {
+public:
+  ScopedStageTimer(StageProfiler &p, Stage::Id s) noexcept
+      : profiler(p), stage(s), start(Clock::now()) {}
+
+  ~ScopedStageTimer() noexcept {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start);
+    profiler.add(stage, static_cast<uint64_t>(elapsed.count()));
+  }
+
+  ScopedStageTimer(const ScopedStageTimer &) = delete;
+  ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+private:
+  StageProfiler &profiler;
+  Stage::Id stage;
+  typename Clock::time_point start;
+};
@@ -0,0 +1,56 @@
+#include "StageProfilerView.h"
+
+StageProfilerView::StageProfilerView(StageProfiler &stageProfiler)
+    : profiler(stageProfiler) {
+  if (StageProfiler::Enabled) {
+    startTimerHz(4);
+  }
+}
+
+StageProfilerView::~StageProfilerView() { stopTimer(); }
+
+void StageProfilerView::timerCallback() {
+  for (int stage = 0; stage < Stage::Count; ++stage) {
+    counters[static_cast<size_t>(stage)] =
+        profiler.getCounters(static_cast<Stage::Id>(stage));
+  }
+  repaint();
+}
+
+void StageProfilerView::mouseDoubleClick(const juce::MouseEvent &) {
+  profiler.reset();
+}
+
+void StageProfilerView::paint(juce::Graphics &g) {
+  g.fillAll(getLookAndFeel()
+                .findColour(juce::ResizableWindow::backgroundColourId)
+                .darker(0.2f));
+  g.setColour(getLookAndFeel().findColour(juce::Label::textColourId));
+  g.setFont(juce::FontOptions(12.0f));
+
+  auto bounds = getLocalBounds().reduced(6, 4);
+  auto drawRow = [&bounds, &g](const juce::String &name,
+                               const juce::String &calls,
+                               const juce::String &mean,
+                               const juce::String &max) {
+    auto row = bounds.removeFromTop(RowHeight);
+    const int column = row.getWidth() / 4;
+    g.drawText(name, row.removeFromLeft(column),
+               juce::Justification::centredLeft);
+    g.drawText(calls, row.removeFromLeft(column),
+               juce::Justification::centredRight);
+    g.drawText(mean, row.removeFromLeft(column),
+               juce::Justification::centredRight);
+    g.drawText(max, row, juce::Justification::centredRight);
+  };
+
+  drawRow("Stage", "Calls", "Mean us", "Max us");
+  for (int stage = 0; stage < Stage::Count; ++stage) {
+    const auto &c = counters[static_cast<size_t>(stage)];
+    const auto &name = Stage::Names[static_cast<size_t>(stage)];
+    drawRow(juce::String(name.data(), name.size()),
+            juce::String(static_cast<juce::int64>(c.calls)),
+            juce::String(c.getMeanNs() / 1000.0, 2),
+            juce::String(static_cast<double>(c.maxNs) / 1000.0, 2));
+  }
+}
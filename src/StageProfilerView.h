@@ -0,0 +1,28 @@
+#pragma once
+
+#include "StageProfiler.h"
+
+#include <JuceHeader.h>
+
+// Table of the per-stage processBlock timings, refreshed a few times per
+// second, double click resets the counters. Only shown by the editor when
+// the profiler is compiled in.
+class StageProfilerView : public juce::Component, private juce::Timer {
+public:
+  static constexpr int RowHeight = 16;
+  static constexpr int PreferredHeight = (Stage::Count + 1) * RowHeight + 8;
+
+  explicit StageProfilerView(StageProfiler &stageProfiler);
+  ~StageProfilerView() override;
+
+  void paint(juce::Graphics &) override;
+  void mouseDoubleClick(const juce::MouseEvent &) override;
+
+private:
+  void timerCallback() override;
+
+  StageProfiler &profiler;
+  std::array<StageProfiler::Counters, Stage::Count> counters;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StageProfilerView)
+};
@@ -0,0 +1,481 @@
+// Renders a corpus of test signals through the reference chain (see
+// ReferenceChain.h) and through every optimised variant of the processing,
+// then compares them. Each variant has its own limits on the maximum and RMS
+// error, relative to the reference peak and RMS, and on the difference of the
+// averaged magnitude spectra. Exits with a non-zero status if any limit is
+// exceeded.
+
+#include "FormantTable.h"
+#include "PluginProcessor.h"
+#include "ProgramBank.h"
+#include "ReferenceChain.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr double twoPi = juce::MathConstants<double>::twoPi;
+
+// ---------------------------------------------------------------------------
+// Signals, all mono and normalised to a peak of 0.5
+
+using Generator = void (*)(double sampleRate, float *out, int numSamples);
+
+void sine(double sampleRate, float *out, int numSamples, double frequency) {
+  for (int i = 0; i < numSamples; ++i) {
+    out[i] = static_cast<float>(std::sin(twoPi * frequency * i / sampleRate));
+  }
+}
+
+void sineLow(double sr, float *out, int n) { sine(sr, out, n, 110.0); }
+void sineMid(double sr, float *out, int n) { sine(sr, out, n, 1000.0); }
+void sineHigh(double sr, float *out, int n) { sine(sr, out, n, 6000.0); }
+
+// Exponential sweep from 20 Hz to just below Nyquist
+void sweep(double sampleRate, float *out, int numSamples) {
+  const double start = 20.0;
+  const double end = sampleRate * 0.45;
+  const double duration = numSamples / sampleRate;
+  const double rate = std::log(end / start);
+  for (int i = 0; i < numSamples; ++i) {
+    const double t = i / sampleRate;
+    const double phase =
+        twoPi * start * duration / rate * (std::exp(t / duration * rate) - 1.0);
+    out[i] = static_cast<float>(std::sin(phase));
+  }
+}
+
+void noise(double, float *out, int numSamples) {
+  juce::Random random(11);
+  for (int i = 0; i < numSamples; ++i) {
+    out[i] = random.nextFloat() * 2.0f - 1.0f;
+  }
+}
+
+// Vowel-like signal: a sawtooth glottal source with vibrato and a little
+// aspiration, shaped by two resonances that step through vowel formants and
+// gated into syllables at 4 Hz
+void speechLike(double sampleRate, float *out, int numSamples) {
+  struct Formants {
+    double first, second;
+  };
+  const std::array<Formants, 4> vowels{
+      {{730.0, 1090.0}, {270.0, 2290.0}, {300.0, 870.0}, {530.0, 1840.0}}};
+  const double bandwidth = 90.0;
+  const double r = std::exp(-juce::MathConstants<double>::pi * bandwidth /
+                            sampleRate);
+
+  juce::Random random(5);
+  double phase = 0.0;
+  std::array<std::array<double, 2>, 2> state{};
+  for (int i = 0; i < numSamples; ++i) {
+    const double t = i / sampleRate;
+    const double pitch = 120.0 + 10.0 * std::sin(twoPi * 5.0 * t);
+    phase += pitch / sampleRate;
+    phase -= std::floor(phase);
+    const double source =
+        2.0 * phase - 1.0 + 0.05 * (random.nextDouble() - 0.5);
+
+    const auto syllable = static_cast<size_t>(t * 4.0);
+    const auto &vowel = vowels[syllable % vowels.size()];
+    const std::array<double, 2> frequencies{vowel.first, vowel.second};
+
+    double voiced = 0.0;
+    for (size_t f = 0; f < 2; ++f) {
+      const double theta = twoPi * frequencies[f] / sampleRate;
+      const double y = source * (1.0 - r) + 2.0 * r * std::cos(theta) *
+                                                state[f][0] -
+                       r * r * state[f][1];
+      state[f][1] = state[f][0];
+      state[f][0] = y;
+      voiced += f == 0 ? y : 0.5 * y;
+    }
+
+    const double syllablePhase = t * 4.0 - std::floor(t * 4.0);
+    const double envelope = std::pow(
+        std::sin(juce::MathConstants<double>::pi * syllablePhase), 2.0);
+    out[i] = static_cast<float>(voiced * envelope);
+  }
+}
+
+struct Signal {
+  const char *name;
+  Generator generate;
+};
+
+const Signal signals[] = {
+    {"sine_110", sineLow}, {"sine_1k", sineMid},   {"sine_6k", sineHigh},
+    {"sweep", sweep},      {"noise", noise},       {"speech", speechLike},
+};
+
+juce::AudioBuffer<float> render(const Signal &testSignal, double sampleRate,
+                                int numSamples) {
+  juce::AudioBuffer<float> buffer(1, numSamples);
+  testSignal.generate(sampleRate, buffer.getWritePointer(0), numSamples);
+  const float peak = buffer.getMagnitude(0, 0, numSamples);
+  if (peak > 0.0f) {
+    buffer.applyGain(0.5f / peak);
+  }
+  return buffer;
+}
+
+// ---------------------------------------------------------------------------
+// Settings and variants
+
+// What the chain is asked to do. Variants driven by a factory program get
+// its index, the others a plain frogginess and unity output gain.
+struct Setting {
+  double sampleRate;
+  int blockSize;
+  float frogginess;
+  float outputGain;
+  int program;
+};
+
+struct Limits {
+  double maxDb;
+  double rmsDb;
+  double spectralDb;
+};
+
+// Runs fn over the buffer one host block at a time
+template <typename Fn>
+void forEachBlock(juce::AudioBuffer<float> &buffer, int blockSize, Fn &&fn) {
+  for (int start = 0; start < buffer.getNumSamples(); start += blockSize) {
+    const int numSamples =
+        juce::jmin(blockSize, buffer.getNumSamples() - start);
+    float *channels[] = {buffer.getWritePointer(0, start)};
+    juce::AudioBuffer<float> block(channels, 1, numSamples);
+    fn(block);
+  }
+}
+
+juce::dsp::ProcessSpec makeSpec(const Setting &setting) {
+  return {setting.sampleRate, static_cast<juce::uint32>(setting.blockSize), 1};
+}
+
+void renderReference(juce::AudioBuffer<float> &buffer, const Setting &setting) {
+  ReferenceChain reference;
+  reference.prepare(makeSpec(setting));
+  forEachBlock(buffer, setting.blockSize, [&](juce::AudioBuffer<float> &block) {
+    reference.process(block, setting.frogginess, setting.outputGain);
+  });
+}
+
+// The optimised chain with the given coefficients and the shaper
+void renderChain(juce::AudioBuffer<float> &buffer, const Setting &setting,
+                 const FormantTable::Bands &coefficients) {
+  if (setting.frogginess < 0.001f) {
+    buffer.applyGain(setting.outputGain);
+    return;
+  }
+  DynamicsAudioProcessor::Chain chain;
+  chain.prepare(makeSpec(setting));
+  chain.get<0>().setCoefficients(coefficients[0]);
+  chain.get<1>().setCoefficients(coefficients[1]);
+  chain.get<2>().setCoefficients(coefficients[2]);
+  chain.get<3>().frogginess = setting.frogginess;
+  forEachBlock(buffer, setting.blockSize, [&](juce::AudioBuffer<float> &block) {
+    juce::dsp::AudioBlock<float> audioBlock(block);
+    chain.process(juce::dsp::ProcessContextReplacing<float>(audioBlock));
+    block.applyGain(setting.outputGain);
+  });
+}
+
+// Exact coefficients: the formant band kernel and the shaper
+void renderKernel(juce::AudioBuffer<float> &buffer, const Setting &setting) {
+  renderChain(buffer, setting,
+              FormantTable::compute(setting.sampleRate, setting.frogginess));
+}
+
+// Coefficients interpolated from the shared table
+void renderTable(juce::AudioBuffer<float> &buffer, const Setting &setting) {
+  FormantTable::Bands coefficients;
+  FormantTable::getShared(setting.sampleRate)
+      ->lookup(setting.frogginess, coefficients);
+  renderChain(buffer, setting, coefficients);
+}
+
+void setParameter(DynamicsAudioProcessor &processor, Param::Index index,
+                  float value) {
+  auto *param = processor.getParameterManager().getParameter(index);
+  param->setValueNotifyingHost(param->convertTo0to1(value));
+}
+
+void runProcessor(DynamicsAudioProcessor &processor,
+                  juce::AudioBuffer<float> &buffer, const Setting &setting) {
+  auto layout = processor.getBusesLayout();
+  layout.getChannelSet(true, 0) = juce::AudioChannelSet::mono();
+  layout.getChannelSet(false, Bus::Main) = juce::AudioChannelSet::mono();
+  processor.setBusesLayout(layout);
+
+  // Parameters set before prepareToPlay are applied without smoothing
+  processor.prepareToPlay(setting.sampleRate, setting.blockSize);
+  juce::MidiBuffer midi;
+  forEachBlock(buffer, setting.blockSize, [&](juce::AudioBuffer<float> &block) {
+    processor.processBlock(block, midi);
+  });
+  processor.releaseResources();
+}
+
+// The whole processBlock on the static path
+void renderProcessBlock(juce::AudioBuffer<float> &buffer,
+                        const Setting &setting) {
+  DynamicsAudioProcessor processor;
+  setParameter(processor, Param::Enabled, 1.0f);
+  setParameter(processor, Param::MorphEnabled, 0.0f);
+  setParameter(processor, Param::FroginessLevel, setting.frogginess * 100.0f);
+  setParameter(processor, Param::OutputGain, 0.0f);
+  runProcessor(processor, buffer, setting);
+}
+
+// processBlock on the morph path with every snapshot on the same program,
+// so any position must sound like the program itself
+void renderMorph(juce::AudioBuffer<float> &buffer, const Setting &setting) {
+  DynamicsAudioProcessor processor;
+  setParameter(processor, Param::Enabled, 1.0f);
+  setParameter(processor, Param::MorphEnabled, 1.0f);
+  setParameter(processor, Param::MorphPosition, 37.0f);
+  const auto &values = ProgramBank::getFactoryBank()[setting.program].values;
+  for (size_t slot = 0; slot < MorphEngine::NumSnapshots; ++slot) {
+    processor.setMorphSnapshot(slot, {values[Param::FroginessLevel],
+                                      values[Param::OutputGain]});
+  }
+  runProcessor(processor, buffer, setting);
+}
+
+struct Variant {
+  const char *name;
+  bool usesPrograms;
+  Limits limits;
+  void (*render)(juce::AudioBuffer<float> &, const Setting &);
+};
+
+// Limits leave headroom over the measured error of each variant. The kernel
+// is the same filter as juce's and must match it closely; table lookup adds
+// interpolation error around -85 dB.
+const Variant variants[] = {
+    {"kernel", false, {-90.0, -100.0, 0.01}, renderKernel},
+    {"table", false, {-60.0, -70.0, 0.05}, renderTable},
+    {"process_block", false, {-60.0, -70.0, 0.05}, renderProcessBlock},
+    {"morph", true, {-55.0, -65.0, 0.1}, renderMorph},
+};
+
+// ---------------------------------------------------------------------------
+// Comparison
+
+struct Errors {
+  double maxDb;
+  double rmsDb;
+  double spectralDb;
+};
+
+double toDb(double ratio) {
+  return 20.0 * std::log10(juce::jmax(ratio, 1.0e-20));
+}
+
+// Magnitude spectrum averaged over Hann windowed frames with 50% overlap
+std::vector<double> averageSpectrum(const juce::AudioBuffer<float> &buffer) {
+  constexpr int order = 12;
+  constexpr int size = 1 << order;
+  juce::dsp::FFT fft(order);
+  juce::dsp::WindowingFunction<float> window(
+      size, juce::dsp::WindowingFunction<float>::hann, false);
+
+  std::vector<double> spectrum(size / 2 + 1, 0.0);
+  std::vector<float> frame(2 * size);
+  const auto *samples = buffer.getReadPointer(0);
+  for (int start = 0; start + size <= buffer.getNumSamples();
+       start += size / 2) {
+    std::fill(frame.begin(), frame.end(), 0.0f);
+    std::copy(samples + start, samples + start + size, frame.begin());
+    window.multiplyWithWindowingTable(frame.data(), size);
+    fft.performFrequencyOnlyForwardTransform(frame.data(), true);
+    for (size_t bin = 0; bin < spectrum.size(); ++bin) {
+      spectrum[bin] += frame[bin];
+    }
+  }
+  return spectrum;
+}
+
+// Largest spectral difference over the bins within 40 dB of the reference
+// peak, quieter bins only measure leakage and noise floor
+double spectralDifferenceDb(const juce::AudioBuffer<float> &reference,
+                            const juce::AudioBuffer<float> &output) {
+  const auto a = averageSpectrum(reference);
+  const auto b = averageSpectrum(output);
+  const double threshold = *std::max_element(a.begin(), a.end()) * 0.01;
+  double worst = 0.0;
+  for (size_t bin = 0; bin < a.size(); ++bin) {
+    if (a[bin] > threshold && a[bin] > 0.0) {
+      worst = juce::jmax(worst, std::abs(toDb(b[bin] / a[bin])));
+    }
+  }
+  return worst;
+}
+
+Errors compare(const juce::AudioBuffer<float> &reference,
+               const juce::AudioBuffer<float> &output) {
+  const auto *ref = reference.getReadPointer(0);
+  const auto *out = output.getReadPointer(0);
+  double peak = 0.0, maxError = 0.0, refPower = 0.0, errorPower = 0.0;
+  for (int i = 0; i < reference.getNumSamples(); ++i) {
+    const double error = static_cast<double>(out[i]) - ref[i];
+    peak = juce::jmax(peak, std::abs(static_cast<double>(ref[i])));
+    maxError = juce::jmax(maxError, std::abs(error));
+    refPower += static_cast<double>(ref[i]) * ref[i];
+    errorPower += error * error;
+  }
+  return {toDb(maxError / juce::jmax(peak, 1.0e-20)),
+          toDb(std::sqrt(errorPower / juce::jmax(refPower, 1.0e-40))),
+          spectralDifferenceDb(reference, output)};
+}
+
+bool withinLimits(const Errors &errors, const Limits &limits) {
+  return errors.maxDb <= limits.maxDb && errors.rmsDb <= limits.rmsDb &&
+         errors.spectralDb <= limits.spectralDb;
+}
+
+// Factory programs usable for the morph comparison: the morph path always
+// processes, so programs below the static path bypass threshold are skipped
+std::vector<int> getMorphPrograms() {
+  std::vector<int> programs;
+  const auto &bank = ProgramBank::getFactoryBank();
+  for (int p = 0; p < bank.size(); ++p) {
+    if (bank[p].enabled && bank[p].frogginess >= 0.001f) {
+      programs.push_back(p);
+    }
+  }
+  return programs;
+}
+
+std::vector<double> getNumberList(const juce::ArgumentList &args,
+                                  const juce::String &option,
+                                  std::vector<double> defaultValues) {
+  if (!args.containsOption(option)) {
+    return defaultValues;
+  }
+  juce::StringArray tokens;
+  tokens.addTokens(args.getValueForOption(option), ",", {});
+  tokens.removeEmptyStrings();
+  std::vector<double> values;
+  for (const auto &token : tokens) {
+    values.push_back(token.getDoubleValue());
+  }
+  return values;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  if (args.containsOption("--help|-h")) {
+    std::cout << "Usage: frogify_golden [--sample-rates 44100,48000,96000] "
+                 "[--frogginess 0,0.25,0.5,0.75,1] [--block-size N] "
+                 "[--seconds S] [--verbose]\n";
+    return 0;
+  }
+
+  // The processor owns an APVTS, which needs a message manager
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  // FROGIFY_CAPTURE set for a host session must not record the tool itself
+  SessionCapture::setEnvironmentCaptureAllowed(false);
+
+  const auto sampleRates =
+      getNumberList(args, "--sample-rates", {44100, 48000, 96000});
+  const auto frogginessLevels =
+      getNumberList(args, "--frogginess", {0.0, 0.25, 0.5, 0.75, 1.0});
+  const int blockSize =
+      args.containsOption("--block-size")
+          ? args.getValueForOption("--block-size").getIntValue()
+          : 512;
+  const double seconds =
+      args.containsOption("--seconds")
+          ? args.getValueForOption("--seconds").getDoubleValue()
+          : 2.0;
+  const bool verbose = args.containsOption("--verbose");
+
+  const auto &bank = ProgramBank::getFactoryBank();
+  const auto morphPrograms = getMorphPrograms();
+
+  int numComparisons = 0;
+  int numFailures = 0;
+  auto check = [&](const Variant &variant, const Signal &testSignal,
+                   const Setting &setting,
+                   const juce::AudioBuffer<float> &input,
+                   const juce::AudioBuffer<float> &reference) {
+    juce::AudioBuffer<float> output(input);
+    variant.render(output, setting);
+    const auto errors = compare(reference, output);
+    const bool passed = withinLimits(errors, variant.limits);
+    ++numComparisons;
+    numFailures += passed ? 0 : 1;
+
+    if (verbose || !passed) {
+      // Precision sticks to the stream, restore it for the next line
+      const auto flags = std::cout.flags();
+      const auto precision = std::cout.precision();
+      std::cout << (passed ? "ok   " : "FAIL ") << std::left << std::setw(14)
+                << variant.name << std::setw(9) << testSignal.name
+                << std::right << std::setw(6) << setting.sampleRate << " Hz ";
+      if (setting.program >= 0) {
+        std::cout << "program " << bank[setting.program].name;
+      } else {
+        std::cout << "frogginess " << setting.frogginess;
+      }
+      std::cout << std::fixed << std::setprecision(1) << "  max "
+                << errors.maxDb << " dB, rms " << errors.rmsDb
+                << " dB, spectrum " << std::setprecision(3)
+                << errors.spectralDb << " dB" << std::endl;
+      std::cout.flags(flags);
+      std::cout.precision(precision);
+    }
+  };
+
+  for (const auto sampleRate : sampleRates) {
+    const int numSamples =
+        juce::jmax(1, static_cast<int>(sampleRate * seconds));
+    for (const auto &testSignal : signals) {
+      const auto input = render(testSignal, sampleRate, numSamples);
+
+      for (const auto frogginess : frogginessLevels) {
+        const Setting setting{sampleRate, juce::jmax(1, blockSize),
+                              static_cast<float>(frogginess), 1.0f, -1};
+        juce::AudioBuffer<float> reference(input);
+        renderReference(reference, setting);
+        for (const auto &variant : variants) {
+          if (!variant.usesPrograms) {
+            check(variant, testSignal, setting, input, reference);
+          }
+        }
+      }
+
+      for (const auto program : morphPrograms) {
+        const Setting setting{sampleRate, juce::jmax(1, blockSize),
+                              bank[program].frogginess,
+                              bank[program].outputGain, program};
+        juce::AudioBuffer<float> reference(input);
+        renderReference(reference, setting);
+        for (const auto &variant : variants) {
+          if (variant.usesPrograms) {
+            check(variant, testSignal, setting, input, reference);
+          }
+        }
+      }
+    }
+  }
+
+  if (numFailures > 0) {
+    std::cout << "FAILED: " << numFailures << " of " << numComparisons
+              << " comparisons exceed their limits" << std::endl;
+    return 1;
+  }
+  std::cout << "OK: " << numComparisons << " comparisons within limits"
+            << std::endl;
+  return 0;
+}
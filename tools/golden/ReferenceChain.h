@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <cmath>
+
+// The processing chain as first written with stock juce::dsp processors:
+// three StateVariableTPTFilter bandpass bands, each followed by a Gain, and
+// the std::tanh waveshaper, with the parameters mapped exactly as the
+// original processBlock did. It is deliberately kept apart from the
+// optimised code, every fast path is validated against its output.
+class ReferenceChain {
+public:
+  void prepare(const juce::dsp::ProcessSpec &spec) {
+    chain.prepare(spec);
+    setupBand(chain.get<0>(), 200.0f);
+    setupBand(chain.get<1>(), 700.0f);
+    setupBand(chain.get<2>(), 1400.0f);
+  }
+
+  // One host block at a fixed frogginess in [0, 1] and linear output gain
+  void process(juce::AudioBuffer<float> &buffer, float frogginess,
+               float outputGain) {
+    if (frogginess < 0.001f) {
+      buffer.applyGain(outputGain);
+      return;
+    }
+
+    const float gainDb = juce::jmap(frogginess, 0.0f, 1.0f, 0.0f, 18.0f);
+    const float resonance = juce::jmap(frogginess, 0.0f, 1.0f, 1.0f, 5.0f);
+    updateBand(chain.get<0>(), resonance, gainDb);
+    updateBand(chain.get<1>(), resonance, gainDb);
+    updateBand(chain.get<2>(), resonance, gainDb);
+    chain.get<3>().frogginess = frogginess;
+
+    juce::dsp::AudioBlock<float> block(buffer);
+    chain.process(juce::dsp::ProcessContextReplacing<float>(block));
+    buffer.applyGain(outputGain);
+  }
+
+private:
+  using Filter = juce::dsp::StateVariableTPTFilter<float>;
+  using Band = juce::dsp::ProcessorChain<Filter, juce::dsp::Gain<float>>;
+
+  struct Shaper {
+    float frogginess = 0.0f;
+    void prepare(const juce::dsp::ProcessSpec &) {}
+    void reset() {}
+
+    template <typename ProcessContext>
+    void process(const ProcessContext &context) noexcept {
+      auto &block = context.getOutputBlock();
+      for (size_t ch = 0; ch < block.getNumChannels(); ++ch) {
+        auto *samples = block.getChannelPointer(ch);
+        for (size_t i = 0; i < block.getNumSamples(); ++i) {
+          const auto distorted =
+              std::tanh(samples[i] * (1.0f + frogginess * 4.0f));
+          samples[i] =
+              samples[i] * (1.0f - frogginess) + distorted * frogginess;
+        }
+      }
+    }
+  };
+
+  static void setupBand(Band &band, float centreFrequency) {
+    band.get<0>().setType(juce::dsp::StateVariableTPTFilterType::bandpass);
+    band.get<0>().setCutoffFrequency(centreFrequency);
+  }
+
+  static void updateBand(Band &band, float resonance, float gainDb) {
+    band.get<0>().setResonance(resonance);
+    band.get<1>().setGainDecibels(gainDb);
+  }
+
+  juce::dsp::ProcessorChain<Band, Band, Band, Shaper> chain;
+};
@@ -0,0 +1,203 @@
+#include "ChunkedRender.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
+ChunkedRender::ChunkedRender(
+    const Options &chunkOptions,
+    std::vector<std::unique_ptr<OfflineRenderer>> &workers,
+    WorkStealingPool &workerPool)
+    : options(chunkOptions), renderers(workers), pool(workerPool) {
+  jassert(static_cast<int>(renderers.size()) == pool.getNumWorkers());
+  formats.registerBasicFormats();
+}
+
+RenderResult ChunkedRender::render(const juce::File &input,
+                                   const juce::File &output) {
+  RenderResult result;
+  result.input = input;
+  seamReport = {};
+  const auto start = std::chrono::steady_clock::now();
+
+  auto reader = renderers.front()->createReader(input);
+  if (reader == nullptr) {
+    result.error = "Cannot read " + input.getFullPathName();
+    return result;
+  }
+  result.memoryMapped =
+      dynamic_cast<juce::MemoryMappedAudioFormatReader *>(reader.get()) !=
+      nullptr;
+  auto writer =
+      OfflineRenderer::createWriter(formats, output, *reader, result.error);
+  if (writer == nullptr) {
+    return result;
+  }
+
+  const auto length = reader->lengthInSamples;
+  // Chunks are AudioBuffers, which count samples in int
+  const auto chunkFrames = static_cast<juce::int64>(
+      juce::jlimit(1.0, static_cast<double>(std::numeric_limits<int>::max()),
+                   options.chunkSeconds * reader->sampleRate));
+  const auto prerollFrames = static_cast<juce::int64>(
+      juce::jlimit(0.0, static_cast<double>(length),
+                   options.prerollSeconds * reader->sampleRate));
+  const auto numChunks = (length + chunkFrames - 1) / chunkFrames;
+  const auto numSlots =
+      static_cast<juce::int64>(2 * static_cast<size_t>(pool.getNumWorkers()));
+
+  // Chunk k renders into slot k % numSlots, finished[slot] names the chunk
+  // last completed there
+  std::vector<juce::AudioBuffer<float>> chunks(static_cast<size_t>(numSlots));
+  std::vector<juce::String> errors(static_cast<size_t>(numSlots));
+  std::vector<juce::int64> finished(static_cast<size_t>(numSlots), -1);
+  std::mutex mutex;
+  std::condition_variable chunkFinished;
+  std::atomic<bool> cancelled{false};
+
+  auto post = [&](juce::int64 index) {
+    const auto slot = static_cast<size_t>(index % numSlots);
+    pool.post({[&, index, slot](int worker) {
+      if (!cancelled.load()) {
+        const auto chunkStart = index * chunkFrames;
+        renderChunk(*renderers[static_cast<size_t>(worker)], input,
+                    chunkStart, juce::jmin(chunkFrames, length - chunkStart),
+                    prerollFrames, chunks[slot], errors[slot]);
+      }
+      // Notify under the lock, render() may return as soon as it is released
+      std::lock_guard<std::mutex> lock(mutex);
+      finished[slot] = index;
+      chunkFinished.notify_one();
+    }});
+  };
+
+  for (juce::int64 index = 0; index < juce::jmin(numSlots, numChunks);
+       ++index) {
+    post(index);
+  }
+  for (juce::int64 index = 0; index < numChunks; ++index) {
+    const auto slot = static_cast<size_t>(index % numSlots);
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      chunkFinished.wait(lock, [&] { return finished[slot] == index; });
+    }
+
+    if (errors[slot].isNotEmpty()) {
+      result.error = errors[slot];
+      // Queued chunks skip their work, but still refer to this frame
+      cancelled.store(true);
+      pool.wait();
+      writer.reset();
+      output.deleteFile();
+      return result;
+    }
+    writer->writeFromAudioSampleBuffer(chunks[slot], 0,
+                                       chunks[slot].getNumSamples());
+    if (index + numSlots < numChunks) {
+      post(index + numSlots);
+    }
+  }
+  writer.reset();
+
+  result.numFrames = length;
+  result.sampleRate = reader->sampleRate;
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+  if (options.verifySeams) {
+    verify(input, output, chunkFrames, prerollFrames, result.error);
+  }
+  return result;
+}
+
+void ChunkedRender::renderChunk(OfflineRenderer &renderer,
+                                const juce::File &input, juce::int64 start,
+                                juce::int64 numFrames,
+                                juce::int64 prerollFrames,
+                                juce::AudioBuffer<float> &chunk,
+                                juce::String &error) {
+  auto chunkReader = renderer.createReader(input);
+  if (chunkReader == nullptr) {
+    error = "Cannot read " + input.getFullPathName();
+    return;
+  }
+  const int numChannels = static_cast<int>(chunkReader->numChannels);
+  chunk.setSize(numChannels, static_cast<int>(numFrames), false, false, true);
+  renderer.renderRange(
+      *chunkReader, start, numFrames, prerollFrames, error,
+      [&chunk, start, numChannels](const juce::AudioBuffer<float> &block,
+                                   juce::int64 position) {
+        const auto offset = static_cast<int>(position - start);
+        for (int ch = 0; ch < numChannels; ++ch) {
+          chunk.copyFrom(ch, offset, block, ch, 0, block.getNumSamples());
+        }
+      });
+}
+
+bool ChunkedRender::verify(const juce::File &input, const juce::File &output,
+                           juce::int64 chunkFrames, juce::int64 prerollFrames,
+                           juce::String &error) {
+  auto &renderer = *renderers.front();
+  auto reader = renderer.createReader(input);
+  std::unique_ptr<juce::AudioFormatReader> written(
+      formats.createReaderFor(output));
+  if (reader == nullptr || written == nullptr) {
+    error = "Cannot read back " + output.getFullPathName();
+    return false;
+  }
+
+  const auto length = reader->lengthInSamples;
+
+  // Integer formats clip and round both renders, allow one step for that
+  const bool isInteger = !written->usesFloatingPointData;
+  seamReport.tolerance = options.seamTolerance;
+  if (isInteger && written->bitsPerSample > 0) {
+    seamReport.tolerance +=
+        std::pow(2.0, 1.0 - static_cast<double>(written->bitsPerSample));
+  }
+  seamReport.numSeams = static_cast<int>(
+      juce::jmax<juce::int64>(0, (length - 1) / chunkFrames));
+
+  juce::AudioBuffer<float> chunked(static_cast<int>(reader->numChannels), 0);
+  return renderer.renderRange(
+      *reader, 0, length, 0, error,
+      [&](const juce::AudioBuffer<float> &block, juce::int64 position) {
+        const int numSamples = block.getNumSamples();
+        chunked.setSize(chunked.getNumChannels(), numSamples, false, false,
+                        true);
+        written->read(&chunked, 0, numSamples, position, true, true);
+
+        for (int i = 0; i < numSamples; ++i) {
+          const auto frame = position + i;
+          // Distance to the nearest seam, the file start and end are none
+          const auto offset = frame % chunkFrames;
+          const auto previous = frame - offset;
+          const auto next = previous + chunkFrames;
+          auto distance = std::numeric_limits<juce::int64>::max();
+          if (previous > 0) {
+            distance = offset;
+          }
+          if (next < length) {
+            distance = juce::jmin(distance, next - frame);
+          }
+          for (int ch = 0; ch < chunked.getNumChannels(); ++ch) {
+            auto serial = block.getSample(ch, i);
+            if (isInteger) {
+              serial = juce::jlimit(-1.0f, 1.0f, serial);
+            }
+            const double difference =
+                std::abs(static_cast<double>(serial) -
+                         chunked.getSample(ch, i));
+            seamReport.maxError = juce::jmax(seamReport.maxError, difference);
+            if (distance <= prerollFrames) {
+              seamReport.maxSeamError =
+                  juce::jmax(seamReport.maxSeamError, difference);
+            }
+          }
+        }
+      });
+}
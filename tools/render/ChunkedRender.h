@@ -0,0 +1,66 @@
+#pragma once
+
+#include "OfflineRenderer.h"
+#include "WorkStealingPool.h"
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+
+// Splits one long file into chunks rendered on every worker at once. Each
+// chunk starts from a freshly prepared processor and first runs a pre-roll
+// of the audio before it, so by the chunk start the formant filters hold the
+// same state a serial render would. Workers finish chunks in any order into
+// a ring of two slots per worker; this thread writes them in file order and
+// hands every written slot the next chunk, so rendering carries on while it
+// writes and memory stays at two chunks per worker.
+class ChunkedRender {
+public:
+  struct Options {
+    double chunkSeconds = 30.0;
+    double prerollSeconds = 0.5;
+    bool verifySeams = false;
+    // Largest accepted difference to a serial render, on top of the output
+    // quantisation step
+    double seamTolerance = 1.0e-4;
+  };
+
+  // Worst difference between the chunked output and a serial render, over
+  // the whole file and within one pre-roll of any seam
+  struct SeamReport {
+    int numSeams = 0;
+    double maxError = 0.0;
+    double maxSeamError = 0.0;
+    double tolerance = 0.0;
+    bool passed() const { return maxError <= tolerance; }
+  };
+
+  ChunkedRender(const Options &chunkOptions,
+                std::vector<std::unique_ptr<OfflineRenderer>> &workers,
+                WorkStealingPool &workerPool);
+
+  RenderResult render(const juce::File &input, const juce::File &output);
+
+  // Only filled when verifySeams is set
+  const SeamReport &getSeamReport() const { return seamReport; }
+
+private:
+  // Renders frames [start, start + numFrames) of the input into chunk on
+  // the given worker's renderer
+  void renderChunk(OfflineRenderer &renderer, const juce::File &input,
+                   juce::int64 start, juce::int64 numFrames,
+                   juce::int64 prerollFrames, juce::AudioBuffer<float> &chunk,
+                   juce::String &error);
+
+  // Renders the input serially on the first worker and compares it with the
+  // written output
+  bool verify(const juce::File &input, const juce::File &output,
+              juce::int64 chunkFrames, juce::int64 prerollFrames,
+              juce::String &error);
+
+  Options options;
+  std::vector<std::unique_ptr<OfflineRenderer>> &renderers;
+  WorkStealingPool &pool;
+  juce::AudioFormatManager formats;
+  SeamReport seamReport;
+};
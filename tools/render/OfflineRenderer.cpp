@@ -0,0 +1,152 @@
+#include "OfflineRenderer.h"
+
+#include <chrono>
+
+juce::String RenderSettings::parseOverrides(const juce::String &text) {
+  juce::StringArray assignments;
+  assignments.addTokens(text, ",", {});
+  assignments.removeEmptyStrings();
+
+  for (const auto &assignment : assignments) {
+    const auto id = assignment.upToFirstOccurrenceOf("=", false, false).trim();
+    const auto value = assignment.fromFirstOccurrenceOf("=", false, false);
+    const auto index = mrta::findParameterIndex(
+        Param::Descriptors, std::string_view(id.toRawUTF8()));
+    if (index == Param::Count || value.isEmpty()) {
+      return "Invalid parameter assignment: " + assignment;
+    }
+    overrides.emplace_back(index, value.getFloatValue());
+  }
+  return {};
+}
+
+OfflineRenderer::OfflineRenderer(const RenderSettings &renderSettings)
+    : settings(renderSettings) {
+  formats.registerBasicFormats();
+  processor.setNonRealtime(true);
+}
+
+bool OfflineRenderer::isSupportedFile(const juce::File &file) {
+  return file.hasFileExtension("wav;aif;aiff");
+}
+
+bool OfflineRenderer::prepare(int numChannels, double sampleRate,
+                              juce::String &error) {
+  if (numChannels < 1 || numChannels > 2) {
+    error = "Only mono and stereo files are supported";
+    return false;
+  }
+
+  processor.releaseResources();
+  const auto channelSet = numChannels == 1 ? juce::AudioChannelSet::mono()
+                                           : juce::AudioChannelSet::stereo();
+  auto layout = processor.getBusesLayout();
+  layout.getChannelSet(true, 0) = channelSet;
+  layout.getChannelSet(false, Bus::Main) = channelSet;
+  if (!processor.setBusesLayout(layout)) {
+    error = "Unsupported channel layout";
+    return false;
+  }
+
+  if (settings.state.getSize() > 0) {
+    processor.setStateInformation(settings.state.getData(),
+                                  static_cast<int>(settings.state.getSize()));
+  }
+  auto &manager = processor.getParameterManager();
+  for (const auto &[index, value] : settings.overrides) {
+    auto *param = manager.getParameter(index);
+    param->setValueNotifyingHost(param->convertTo0to1(value));
+  }
+
+  processor.prepareToPlay(sampleRate, settings.blockSize);
+  buffer.setSize(juce::jmax(processor.getTotalNumInputChannels(),
+                            processor.getTotalNumOutputChannels()),
+                 settings.blockSize);
+  return true;
+}
+
+std::unique_ptr<juce::AudioFormatReader>
+OfflineRenderer::createReader(const juce::File &file) {
+  if (settings.memoryMap) {
+    if (auto *format =
+            formats.findFormatForFileExtension(file.getFileExtension())) {
+      std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(
+          format->createMemoryMappedReader(file));
+      if (mapped != nullptr && mapped->mapEntireFile()) {
+        return mapped;
+      }
+    }
+  }
+  return std::unique_ptr<juce::AudioFormatReader>(
+      formats.createReaderFor(file));
+}
+
+std::unique_ptr<juce::AudioFormatWriter>
+OfflineRenderer::createWriter(juce::AudioFormatManager &formatManager,
+                              const juce::File &output,
+                              const juce::AudioFormatReader &source,
+                              juce::String &error) {
+  auto *format =
+      formatManager.findFormatForFileExtension(output.getFileExtension());
+  if (format == nullptr) {
+    error = "Unsupported output format " + output.getFileName();
+    return nullptr;
+  }
+  output.getParentDirectory().createDirectory();
+  output.deleteFile();
+  auto stream =
+      std::make_unique<juce::FileOutputStream>(output, WriteBufferBytes);
+  if (!stream->openedOk()) {
+    error = "Cannot write " + output.getFullPathName();
+    return nullptr;
+  }
+  std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(
+      stream.get(), source.sampleRate,
+      static_cast<unsigned int>(source.numChannels),
+      static_cast<int>(source.bitsPerSample), source.metadataValues, 0));
+  if (writer == nullptr) {
+    error = "Cannot write " + output.getFullPathName();
+    return nullptr;
+  }
+  stream.release();
+  return writer;
+}
+
+RenderResult OfflineRenderer::renderFile(const juce::File &input,
+                                         const juce::File &output) {
+  RenderResult result;
+  result.input = input;
+  const auto start = std::chrono::steady_clock::now();
+
+  auto reader = createReader(input);
+  if (reader == nullptr) {
+    result.error = "Cannot read " + input.getFullPathName();
+    return result;
+  }
+  result.memoryMapped =
+      dynamic_cast<juce::MemoryMappedAudioFormatReader *>(reader.get()) !=
+      nullptr;
+  auto writer = createWriter(formats, output, *reader, result.error);
+  if (writer == nullptr) {
+    return result;
+  }
+
+  const auto length = reader->lengthInSamples;
+  const bool rendered = renderRange(
+      *reader, 0, length, 0, result.error,
+      [&writer](const juce::AudioBuffer<float> &block, juce::int64) {
+        writer->writeFromAudioSampleBuffer(block, 0, block.getNumSamples());
+      });
+  writer.reset();
+  if (!rendered) {
+    output.deleteFile();
+    return result;
+  }
+
+  result.numFrames = length;
+  result.sampleRate = reader->sampleRate;
+  result.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  return result;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "PluginProcessor.h"
+
+#include <JuceHeader.h>
+#include <utility>
+#include <vector>
+
+// How every file of a batch is processed: an optional saved plugin state,
+// then parameter overrides on top of it in plain parameter units
+struct RenderSettings {
+  juce::MemoryBlock state;
+  std::vector<std::pair<uint32_t, float>> overrides;
+  int blockSize = 4096;
+  // Read inputs through memory-mapped readers where the format allows
+  bool memoryMap = true;
+
+  // Parses "id=value[,id=value...]" using the parameter IDs, returns an
+  // error message or an empty string
+  juce::String parseOverrides(const juce::String &text);
+};
+
+struct RenderResult {
+  juce::File input;
+  juce::String error;
+  juce::int64 numFrames = 0;
+  double sampleRate = 0.0;
+  // Wall clock time, reading and writing included
+  double seconds = 0.0;
+  bool memoryMapped = false;
+
+  bool failed() const { return error.isNotEmpty(); }
+  double getAudioSeconds() const {
+    return sampleRate > 0.0 ? static_cast<double>(numFrames) / sampleRate
+                            : 0.0;
+  }
+  double getRealtimeMultiple() const {
+    return seconds > 0.0 ? getAudioSeconds() / seconds : 0.0;
+  }
+};
+
+// Renders audio through its own processor, reconfigured for every file or
+// range, so one renderer can serve a whole batch from one worker thread.
+// Construct it on the main thread, the processor owns an APVTS.
+class OfflineRenderer {
+public:
+  explicit OfflineRenderer(const RenderSettings &renderSettings);
+
+  RenderResult renderFile(const juce::File &input, const juce::File &output);
+
+  // Reader from this renderer's own format manager, so every worker can
+  // open files independently. WAV and AIFF inputs are memory mapped when
+  // enabled: samples are then converted straight from the mapped pages into
+  // the processing buffer, with no read syscalls and no intermediate copy.
+  // Falls back to a streaming reader if the file cannot be mapped.
+  std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File &file);
+
+  // Processes frames [start, start + numFrames) of the reader from a freshly
+  // prepared processor. The preroll frames before start run first and their
+  // output is dropped, so filter state has converged when start is reached.
+  // onBlock(block, position) receives the output of every block in order.
+  template <typename OnBlock>
+  bool renderRange(juce::AudioFormatReader &reader, juce::int64 start,
+                   juce::int64 numFrames, juce::int64 preroll,
+                   juce::String &error, OnBlock &&onBlock) {
+    if (!prepare(static_cast<int>(reader.numChannels), reader.sampleRate,
+                 error)) {
+      return false;
+    }
+    preroll = juce::jlimit<juce::int64>(0, start, preroll);
+    processRange(reader, start - preroll, preroll,
+                 [](const juce::AudioBuffer<float> &, juce::int64) {});
+    processRange(reader, start, numFrames, onBlock);
+    return true;
+  }
+
+  // Mono or stereo layout, state, overrides, then prepareToPlay so the
+  // parameters apply without smoothing
+  bool prepare(int numChannels, double sampleRate, juce::String &error);
+
+  // Processes one block of at most blockSize frames in place, after
+  // prepare(). For streams that do not come from a reader.
+  void process(juce::AudioBuffer<float> &block) {
+    processor.processBlock(block, midi);
+  }
+
+  // WAV and AIFF, by extension
+  static bool isSupportedFile(const juce::File &file);
+
+  // Size of the output stream buffer, so the disk sees large sequential
+  // writes rather than one per block
+  static constexpr size_t WriteBufferBytes = 4 << 20;
+
+  // Writer for the output file in the format its extension names, with the
+  // sample rate, channels, bit depth and metadata of the source
+  static std::unique_ptr<juce::AudioFormatWriter>
+  createWriter(juce::AudioFormatManager &formatManager,
+               const juce::File &output,
+               const juce::AudioFormatReader &source, juce::String &error);
+
+private:
+  template <typename OnBlock>
+  void processRange(juce::AudioFormatReader &reader, juce::int64 start,
+                    juce::int64 numFrames, OnBlock &&onBlock) {
+    const auto end = start + numFrames;
+    for (auto position = start; position < end;
+         position += settings.blockSize) {
+      const int numSamples = static_cast<int>(
+          juce::jmin<juce::int64>(settings.blockSize, end - position));
+      juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(),
+                                     buffer.getNumChannels(), numSamples);
+      block.clear();
+      reader.read(&block, 0, numSamples, position, true, true);
+      process(block);
+      onBlock(static_cast<const juce::AudioBuffer<float> &>(block), position);
+    }
+  }
+
+  const RenderSettings &settings;
+  DynamicsAudioProcessor processor;
+  juce::AudioFormatManager formats;
+  juce::AudioBuffer<float> buffer;
+  juce::MidiBuffer midi;
+};
@@ -0,0 +1,232 @@
+#include "PcmStream.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Block {
+  std::vector<char> bytes;
+  size_t size = 0;
+};
+
+// Little-endian interleaved samples to and from the float channels of the
+// buffer, integer formats are clipped on the way out
+template <typename SampleFormat>
+void deinterleave(const char *bytes, juce::AudioBuffer<float> &buffer,
+                  int frames) {
+  using namespace juce::AudioData;
+  const int numChannels = buffer.getNumChannels();
+  for (int ch = 0; ch < numChannels; ++ch) {
+    Pointer<SampleFormat, LittleEndian, Interleaved, Const> source(
+        bytes + ch * SampleFormat::bytesPerSample, numChannels);
+    Pointer<Float32, NativeEndian, NonInterleaved, NonConst> dest(
+        buffer.getWritePointer(ch));
+    dest.convertSamples(source, frames);
+  }
+}
+
+template <typename SampleFormat>
+void interleave(const juce::AudioBuffer<float> &buffer, char *bytes,
+                int frames) {
+  using namespace juce::AudioData;
+  const int numChannels = buffer.getNumChannels();
+  for (int ch = 0; ch < numChannels; ++ch) {
+    Pointer<Float32, NativeEndian, NonInterleaved, Const> source(
+        buffer.getReadPointer(ch));
+    Pointer<SampleFormat, LittleEndian, Interleaved, NonConst> dest(
+        bytes + ch * SampleFormat::bytesPerSample, numChannels);
+    dest.convertSamples(source, frames);
+  }
+}
+
+} // namespace
+
+// A fixed set of blocks passed from a producer thread to a consumer thread.
+// The producer takes a free block, fills it and hands it over; the consumer
+// gives it back once done. With two blocks this is double buffering, and
+// either side simply waits when the other falls behind.
+class PcmStream::Exchange {
+public:
+  Exchange(int numBlocks, size_t bytesPerBlock) : blocks(numBlocks) {
+    for (auto &block : blocks) {
+      block.bytes.resize(bytesPerBlock);
+      free.push_back(&block);
+    }
+  }
+
+  Block &acquire() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return !free.empty(); });
+    auto *block = free.front();
+    free.pop_front();
+    return *block;
+  }
+
+  void push(Block &block) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      full.push_back(&block);
+    }
+    condition.notify_all();
+  }
+
+  // Next filled block, nullptr once the producer closed and all are taken
+  Block *pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return !full.empty() || closed; });
+    if (full.empty()) {
+      return nullptr;
+    }
+    auto *block = full.front();
+    full.pop_front();
+    return block;
+  }
+
+  void release(Block &block) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      free.push_back(&block);
+    }
+    condition.notify_all();
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      closed = true;
+    }
+    condition.notify_all();
+  }
+
+private:
+  std::vector<Block> blocks;
+  std::deque<Block *> free;
+  std::deque<Block *> full;
+  bool closed = false;
+  std::mutex mutex;
+  std::condition_variable condition;
+};
+
+bool PcmStream::parseEncoding(const juce::String &text, Encoding &encoding) {
+  if (text == "f32") {
+    encoding = Encoding::Float32;
+    return true;
+  }
+  if (text == "s16") {
+    encoding = Encoding::Int16;
+    return true;
+  }
+  return false;
+}
+
+PcmStream::PcmStream(const Format &streamFormat,
+                     OfflineRenderer &streamRenderer, int framesPerBlock)
+    : format(streamFormat), renderer(streamRenderer),
+      blockSize(framesPerBlock), work(streamFormat.numChannels,
+                                      framesPerBlock) {}
+
+bool PcmStream::run(std::FILE *input, std::FILE *output,
+                    juce::String &error) {
+  if (!renderer.prepare(format.numChannels, format.sampleRate, error)) {
+    return false;
+  }
+
+  const auto bytesPerFrame = static_cast<size_t>(format.getBytesPerFrame());
+  const auto bytesPerBlock = static_cast<size_t>(blockSize) * bytesPerFrame;
+  Exchange filled(2, bytesPerBlock);
+  Exchange processed(2, bytesPerBlock);
+
+  std::thread reader([this, input, &filled] { readerLoop(input, filled); });
+  std::thread writer(
+      [this, output, &processed] { writerLoop(output, processed); });
+
+  while (auto *in = filled.pop()) {
+    const int frames = static_cast<int>(in->size / bytesPerFrame);
+    convertIn(in->bytes.data(), frames);
+    filled.release(*in);
+
+    juce::AudioBuffer<float> block(work.getArrayOfWritePointers(),
+                                   work.getNumChannels(), frames);
+    renderer.process(block);
+    numFrames += frames;
+
+    auto &out = processed.acquire();
+    convertOut(out.bytes.data(), frames);
+    out.size = static_cast<size_t>(frames) * bytesPerFrame;
+    processed.push(out);
+  }
+  processed.close();
+
+  reader.join();
+  writer.join();
+
+  if (readFailed.load()) {
+    error = "Error reading the input stream";
+    return false;
+  }
+  if (writeFailed.load()) {
+    error = "Error writing the output stream";
+    return false;
+  }
+  return true;
+}
+
+// Fills whole blocks, the last one may be short. A trailing partial frame is
+// dropped.
+void PcmStream::readerLoop(std::FILE *input, Exchange &filled) {
+  const auto bytesPerFrame = static_cast<size_t>(format.getBytesPerFrame());
+  while (!writeFailed.load()) {
+    auto &block = filled.acquire();
+    block.size = std::fread(block.bytes.data(), 1, block.bytes.size(), input);
+    block.size -= block.size % bytesPerFrame;
+    const bool finished = block.size < block.bytes.size();
+    if (finished && std::ferror(input) != 0) {
+      readFailed.store(true);
+    }
+    if (block.size > 0) {
+      filled.push(block);
+    } else {
+      filled.release(block);
+    }
+    if (finished) {
+      break;
+    }
+  }
+  filled.close();
+}
+
+// After a failed write, e.g. the reading end of the pipe went away, blocks
+// are still drained so the other threads can finish
+void PcmStream::writerLoop(std::FILE *output, Exchange &processed) {
+  while (auto *block = processed.pop()) {
+    if (!writeFailed.load() &&
+        std::fwrite(block->bytes.data(), 1, block->size, output) !=
+            block->size) {
+      writeFailed.store(true);
+    }
+    processed.release(*block);
+  }
+  if (std::fflush(output) != 0) {
+    writeFailed.store(true);
+  }
+}
+
+void PcmStream::convertIn(const char *bytes, int frames) {
+  if (format.encoding == Encoding::Float32) {
+    deinterleave<juce::AudioData::Float32>(bytes, work, frames);
+  } else {
+    deinterleave<juce::AudioData::Int16>(bytes, work, frames);
+  }
+}
+
+void PcmStream::convertOut(char *bytes, int frames) const {
+  if (format.encoding == Encoding::Float32) {
+    interleave<juce::AudioData::Float32>(work, bytes, frames);
+  } else {
+    interleave<juce::AudioData::Int16>(work, bytes, frames);
+  }
+}
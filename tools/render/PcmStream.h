@@ -0,0 +1,54 @@
+#pragma once
+
+#include "OfflineRenderer.h"
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstdio>
+
+// Raw interleaved little-endian PCM filter, e.g. stdin to stdout in a shell
+// pipeline. Reading, processing and writing run on three threads with two
+// buffers of one block between each pair, so I/O overlaps the DSP while
+// memory and latency stay at a few blocks for streams of any length.
+class PcmStream {
+public:
+  enum class Encoding { Float32, Int16 };
+
+  struct Format {
+    double sampleRate = 48000.0;
+    int numChannels = 2;
+    Encoding encoding = Encoding::Float32;
+
+    int getBytesPerFrame() const {
+      return numChannels * (encoding == Encoding::Float32 ? 4 : 2);
+    }
+  };
+
+  // "f32" or "s16"
+  static bool parseEncoding(const juce::String &text, Encoding &encoding);
+
+  PcmStream(const Format &streamFormat, OfflineRenderer &streamRenderer,
+            int framesPerBlock);
+
+  // Processes until the end of the input. Returns false on a read, write or
+  // setup error.
+  bool run(std::FILE *input, std::FILE *output, juce::String &error);
+
+  juce::int64 getNumFrames() const { return numFrames; }
+
+private:
+  class Exchange;
+
+  void readerLoop(std::FILE *input, Exchange &filled);
+  void writerLoop(std::FILE *output, Exchange &processed);
+  void convertIn(const char *bytes, int frames);
+  void convertOut(char *bytes, int frames) const;
+
+  Format format;
+  OfflineRenderer &renderer;
+  int blockSize;
+  juce::AudioBuffer<float> work;
+  juce::int64 numFrames = 0;
+  std::atomic<bool> readFailed{false};
+  std::atomic<bool> writeFailed{false};
+};
@@ -0,0 +1,311 @@
+// Offline batch renderer. Processes WAV/AIFF files, or every such file in a
+// directory tree, on a work-stealing pool with one processor per worker and
+// reports throughput as a multiple of real time. With --chunk-seconds every
+// file is instead split into chunks rendered on all workers at once, and
+// with --pipe raw PCM is filtered from stdin to stdout.
+
+#include "ChunkedRender.h"
+#include "OfflineRenderer.h"
+#include "PcmStream.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#if JUCE_WINDOWS
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+void printUsage() {
+  std::cerr
+      << "Usage: frogify_render <input file or directory>... --output <path>\n"
+         "       frogify_render --pipe [--sample-rate N] [--channels 1|2]\n"
+         "                      [--format f32|s16]\n"
+         "Options:\n"
+         "         [--set id=value[,id=value...]] [--state file] [--jobs N]\n"
+         "         [--block-size N] [--no-mmap]\n"
+         "         [--chunk-seconds S [--preroll-seconds S]\n"
+         "         [--verify-seams [--seam-tolerance E]]]\n\n"
+         "With a single input file the output may be a file name, otherwise\n"
+         "it is a directory mirroring the inputs. Parameters are set in\n"
+         "their own units on top of the optional state, e.g.\n"
+         "  --set froginess_level=80,output_gain=-3\n"
+         "Chunked rendering parallelises long files, --verify-seams checks\n"
+         "the result against a serial render. --pipe reads interleaved\n"
+         "little-endian PCM from stdin and writes it to stdout, 48000 Hz\n"
+         "stereo f32 by default.\n";
+}
+
+struct Options {
+  juce::Array<juce::File> inputs;
+  juce::File output;
+  juce::String overrides;
+  juce::File stateFile;
+  int jobs = 0;
+  int blockSize = 4096;
+  bool memoryMap = true;
+  bool chunked = false;
+  ChunkedRender::Options chunking;
+  bool pipe = false;
+  PcmStream::Format pcm;
+};
+
+// Options take their value from the next argument, everything else is an
+// input path
+bool parseOptions(int argc, char *argv[], Options &options) {
+  const auto cwd = juce::File::getCurrentWorkingDirectory();
+  bool hasOutput = false;
+  for (int i = 1; i < argc; ++i) {
+    const juce::String arg(argv[i]);
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--output" && hasValue) {
+      options.output = cwd.getChildFile(argv[++i]);
+      hasOutput = true;
+    } else if (arg == "--set" && hasValue) {
+      options.overrides += juce::String(argv[++i]) + ",";
+    } else if (arg == "--state" && hasValue) {
+      options.stateFile = cwd.getChildFile(argv[++i]);
+    } else if (arg == "--jobs" && hasValue) {
+      options.jobs = juce::String(argv[++i]).getIntValue();
+    } else if (arg == "--block-size" && hasValue) {
+      options.blockSize = juce::String(argv[++i]).getIntValue();
+    } else if (arg == "--pipe") {
+      options.pipe = true;
+    } else if (arg == "--sample-rate" && hasValue) {
+      options.pcm.sampleRate = juce::String(argv[++i]).getDoubleValue();
+    } else if (arg == "--channels" && hasValue) {
+      options.pcm.numChannels = juce::String(argv[++i]).getIntValue();
+    } else if (arg == "--format" && hasValue) {
+      if (!PcmStream::parseEncoding(argv[++i], options.pcm.encoding)) {
+        return false;
+      }
+    } else if (arg == "--no-mmap") {
+      options.memoryMap = false;
+    } else if (arg == "--chunk-seconds" && hasValue) {
+      options.chunked = true;
+      options.chunking.chunkSeconds =
+          juce::jmax(0.1, juce::String(argv[++i]).getDoubleValue());
+    } else if (arg == "--preroll-seconds" && hasValue) {
+      options.chunking.prerollSeconds =
+          juce::jmax(0.0, juce::String(argv[++i]).getDoubleValue());
+    } else if (arg == "--verify-seams") {
+      options.chunking.verifySeams = true;
+    } else if (arg == "--seam-tolerance" && hasValue) {
+      options.chunking.seamTolerance = juce::String(argv[++i]).getDoubleValue();
+    } else if (arg.startsWith("-")) {
+      return false;
+    } else {
+      options.inputs.add(cwd.getChildFile(arg));
+    }
+  }
+  if (options.pipe) {
+    return options.inputs.isEmpty() && !hasOutput &&
+           options.pcm.sampleRate > 0.0 &&
+           juce::isPositiveAndNotGreaterThan(options.pcm.numChannels, 2);
+  }
+  return hasOutput && !options.inputs.isEmpty();
+}
+
+// Everything but the audio goes to stderr, stdout carries the stream
+int runPipe(const Options &options, const RenderSettings &settings) {
+#if JUCE_WINDOWS
+  _setmode(_fileno(stdin), _O_BINARY);
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+  OfflineRenderer renderer(settings);
+  PcmStream stream(options.pcm, renderer, settings.blockSize);
+  const auto start = std::chrono::steady_clock::now();
+  juce::String error;
+  const bool succeeded = stream.run(stdin, stdout, error);
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  if (!succeeded) {
+    std::cerr << error << std::endl;
+    return 1;
+  }
+  const double audioSeconds =
+      static_cast<double>(stream.getNumFrames()) / options.pcm.sampleRate;
+  std::cerr << std::fixed << std::setprecision(2) << audioSeconds
+            << " s of audio in " << seconds << " s, "
+            << (seconds > 0.0 ? audioSeconds / seconds : 0.0)
+            << "x real time" << std::endl;
+  return 0;
+}
+
+struct Job {
+  juce::File input;
+  juce::File output;
+};
+
+std::vector<Job> collectJobs(const Options &options) {
+  std::vector<Job> jobs;
+  const bool singleFile = options.inputs.size() == 1 &&
+                          options.inputs[0].existsAsFile() &&
+                          OfflineRenderer::isSupportedFile(options.output);
+  for (const auto &input : options.inputs) {
+    if (input.isDirectory()) {
+      for (const auto &entry : juce::RangedDirectoryIterator(
+               input, true, "*", juce::File::findFiles)) {
+        const auto file = entry.getFile();
+        if (OfflineRenderer::isSupportedFile(file)) {
+          jobs.push_back(
+              {file, options.output.getChildFile(
+                         file.getRelativePathFrom(input))});
+        }
+      }
+    } else if (singleFile) {
+      jobs.push_back({input, options.output});
+    } else {
+      jobs.push_back({input, options.output.getChildFile(input.getFileName())});
+    }
+  }
+  return jobs;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage();
+    return 2;
+  }
+
+  // The processor owns an APVTS, which needs a message manager
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  // FROGIFY_CAPTURE set for a host session must not record the tool itself
+  SessionCapture::setEnvironmentCaptureAllowed(false);
+
+  RenderSettings settings;
+  settings.blockSize = juce::jmax(16, options.blockSize);
+  settings.memoryMap = options.memoryMap;
+  if (options.stateFile != juce::File() &&
+      !options.stateFile.loadFileAsData(settings.state)) {
+    std::cerr << "Cannot read " << options.stateFile.getFullPathName()
+              << std::endl;
+    return 2;
+  }
+  if (const auto error = settings.parseOverrides(options.overrides);
+      error.isNotEmpty()) {
+    std::cerr << error << std::endl;
+    return 2;
+  }
+
+  if (options.pipe) {
+    return runPipe(options, settings);
+  }
+
+  const auto jobs = collectJobs(options);
+  if (jobs.empty()) {
+    std::cerr << "No WAV or AIFF input found" << std::endl;
+    return 2;
+  }
+  // Inputs with the same name from different folders would race on, and
+  // silently overwrite, one output file
+  std::map<juce::String, const Job *> jobsByOutput;
+  for (const auto &job : jobs) {
+    if (job.input == job.output) {
+      std::cerr << "Refusing to overwrite " << job.input.getFullPathName()
+                << std::endl;
+      return 2;
+    }
+    auto key = job.output.getFullPathName();
+    if (!juce::File::areFileNamesCaseSensitive()) {
+      key = key.toLowerCase();
+    }
+    const auto [it, inserted] = jobsByOutput.emplace(key, &job);
+    if (!inserted) {
+      std::cerr << it->second->input.getFullPathName() << " and "
+                << job.input.getFullPathName() << " would both render to "
+                << job.output.getFullPathName() << std::endl;
+      return 2;
+    }
+  }
+
+  const int hardwareThreads =
+      static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  // Chunking keeps every worker busy whatever the number of files
+  const int requested = options.jobs > 0 ? options.jobs : hardwareThreads;
+  const int numWorkers =
+      options.chunked
+          ? juce::jmax(1, requested)
+          : juce::jlimit(1, static_cast<int>(jobs.size()), requested);
+
+  // One renderer, hence one processor, per worker, built on this thread
+  std::vector<std::unique_ptr<OfflineRenderer>> renderers;
+  for (int i = 0; i < numWorkers; ++i) {
+    renderers.push_back(std::make_unique<OfflineRenderer>(settings));
+  }
+
+  std::vector<RenderResult> results(jobs.size());
+  const auto start = std::chrono::steady_clock::now();
+  WorkStealingPool pool(numWorkers);
+
+  if (options.chunked) {
+    // One file at a time, each split over all workers
+    ChunkedRender chunkedRender(options.chunking, renderers, pool);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      results[i] = chunkedRender.render(jobs[i].input, jobs[i].output);
+      const auto &report = chunkedRender.getSeamReport();
+      if (!options.chunking.verifySeams || results[i].failed()) {
+        continue;
+      }
+      std::cout << jobs[i].input.getFileName() << ": " << report.numSeams
+                << " seam(s), max difference to a serial render "
+                << report.maxError << " (" << report.maxSeamError
+                << " near seams, tolerance " << report.tolerance << ")"
+                << std::endl;
+      if (!report.passed()) {
+        results[i].error = "Chunked output differs from a serial render";
+      }
+    }
+  } else {
+    std::vector<WorkStealingPool::Task> tasks;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      tasks.push_back([&renderers, &results, &jobs, i](int worker) {
+        results[i] = renderers[static_cast<size_t>(worker)]->renderFile(
+            jobs[i].input, jobs[i].output);
+      });
+    }
+    pool.run(std::move(tasks));
+  }
+
+  const double wallSeconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  int numFailed = 0;
+  double audioSeconds = 0.0;
+  std::cout << std::fixed << std::setprecision(2);
+  for (const auto &result : results) {
+    if (result.failed()) {
+      ++numFailed;
+      std::cerr << result.input.getFileName() << ": " << result.error
+                << std::endl;
+      continue;
+    }
+    audioSeconds += result.getAudioSeconds();
+    std::cout << result.input.getFileName() << ": "
+              << result.getAudioSeconds() << " s in " << result.seconds
+              << " s, " << result.getRealtimeMultiple() << "x real time"
+              << (result.memoryMapped ? ", mapped" : "") << std::endl;
+  }
+
+  std::cout << results.size() - static_cast<size_t>(numFailed)
+            << " file(s), " << audioSeconds << " s of audio in "
+            << wallSeconds << " s with " << numWorkers << " worker(s), "
+            << (wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0)
+            << "x real time" << std::endl;
+  return numFailed > 0 ? 1 : 0;
+}
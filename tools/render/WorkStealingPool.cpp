@@ -0,0 +1,100 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int numWorkers) {
+  for (int i = 0; i < std::max(1, numWorkers); ++i) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+  for (size_t worker = 0; worker < queues.size(); ++worker) {
+    threads.emplace_back([this, worker] { work(worker); });
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    stopping = true;
+  }
+  tasksPosted.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::post(std::vector<Task> tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(stateMutex);
+  // Round robin across calls, so every worker starts on its own share even
+  // when tasks are posted one at a time
+  for (auto &task : tasks) {
+    auto &queue = *queues[nextQueue];
+    nextQueue = (nextQueue + 1) % queues.size();
+    std::lock_guard<std::mutex> queueLock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  numQueued += tasks.size();
+  numUnfinished += tasks.size();
+  tasksPosted.notify_all();
+}
+
+void WorkStealingPool::wait() {
+  std::unique_lock<std::mutex> lock(stateMutex);
+  tasksDone.wait(lock, [this] { return numUnfinished == 0; });
+}
+
+void WorkStealingPool::run(std::vector<Task> tasks) {
+  post(std::move(tasks));
+  wait();
+}
+
+void WorkStealingPool::work(size_t worker) {
+  Task task;
+  for (;;) {
+    if (take(worker, task)) {
+      task(static_cast<int>(worker));
+      task = nullptr;
+      std::lock_guard<std::mutex> lock(stateMutex);
+      if (--numUnfinished == 0) {
+        tasksDone.notify_all();
+      }
+      continue;
+    }
+
+    // Tasks are counted in numQueued under stateMutex, so a post between
+    // the failed take and this wait still wakes the worker
+    std::unique_lock<std::mutex> lock(stateMutex);
+    tasksPosted.wait(lock, [this] { return stopping || numQueued > 0; });
+    if (stopping && numQueued == 0) {
+      return;
+    }
+  }
+}
+
+bool WorkStealingPool::take(size_t worker, Task &task) {
+  {
+    auto &own = *queues[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      --numQueued;
+      return true;
+    }
+  }
+
+  for (size_t offset = 1; offset < queues.size(); ++offset) {
+    auto &victim = *queues[(worker + offset) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      --numQueued;
+      return true;
+    }
+  }
+  return false;
+}
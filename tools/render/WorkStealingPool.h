@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs tasks on a fixed number of worker threads, started once and kept
+// until the pool is destroyed. Every worker has its own deque: it takes its
+// own tasks from the back and, once it runs out, steals from the front of
+// the others, so a few long tasks at the end of a batch do not leave cores
+// idle. Tasks get the index of the worker running them, so per-worker state
+// such as one processor per worker needs no locking.
+class WorkStealingPool {
+public:
+  using Task = std::function<void(int worker)>;
+
+  explicit WorkStealingPool(int numWorkers);
+  ~WorkStealingPool();
+
+  int getNumWorkers() const { return static_cast<int>(queues.size()); }
+
+  // Spreads the tasks over the workers and returns straight away
+  void post(std::vector<Task> tasks);
+
+  // Blocks until every posted task ran
+  void wait();
+
+  // Posts the tasks and blocks until all of them ran
+  void run(std::vector<Task> tasks);
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void work(size_t worker);
+  bool take(size_t worker, Task &task);
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> threads;
+
+  // Guards the counters below and both condition variables
+  std::mutex stateMutex;
+  std::condition_variable tasksPosted;
+  std::condition_variable tasksDone;
+  // Posted but not taken yet, and posted but not finished yet
+  std::atomic<size_t> numQueued{0};
+  size_t numUnfinished = 0;
+  size_t nextQueue = 0;
+  bool stopping = false;
+};
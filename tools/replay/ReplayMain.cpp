@@ -0,0 +1,153 @@
+// Replays a session recorded with FROGIFY_CAPTURE through a fresh processor,
+// reports how long processBlock took and checks every iteration produced
+// the same output. Exits with a non-zero status if the capture cannot be
+// read or the output differs between iterations.
+
+#include "PluginProcessor.h"
+#include "SessionReplay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+int getIntOption(const juce::ArgumentList &args, const juce::String &option,
+                 int defaultValue) {
+  if (!args.containsOption(option)) {
+    return defaultValue;
+  }
+  return args.getValueForOption(option).getIntValue();
+}
+
+double percentile(std::vector<double> samples, double fraction) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples[static_cast<size_t>(fraction * (samples.size() - 1))];
+}
+
+// Order sensitive checksum of the output samples, bit exact
+uint64_t hashBlock(uint64_t hash, const juce::AudioBuffer<float> &buffer) {
+  for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
+    const auto *samples = buffer.getReadPointer(ch);
+    for (int i = 0; i < buffer.getNumSamples(); ++i) {
+      uint32_t bits;
+      std::memcpy(&bits, samples + i, sizeof(bits));
+      hash = (hash ^ bits) * 0x100000001b3ull;
+    }
+  }
+  return hash;
+}
+
+std::unique_ptr<juce::AudioFormatWriter>
+createWavWriter(const juce::File &file, double sampleRate, int numChannels) {
+  file.deleteFile();
+  auto stream = std::make_unique<juce::FileOutputStream>(file);
+  if (!stream->openedOk()) {
+    return nullptr;
+  }
+  juce::WavAudioFormat format;
+  std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(
+      stream.get(), sampleRate, static_cast<unsigned int>(numChannels), 32,
+      {}, 0));
+  if (writer != nullptr) {
+    stream.release();
+  }
+  return writer;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  if (args.containsOption("--help|-h") || args.size() == 0) {
+    std::cout << "Usage: frogify_replay capture [--iterations N] "
+                 "[--output processed.wav]\n";
+    return 0;
+  }
+
+  // The processor owns an APVTS, which needs a message manager
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  // FROGIFY_CAPTURE set for a host session must not record the tool itself
+  SessionCapture::setEnvironmentCaptureAllowed(false);
+
+  const juce::File captureFile = args[0].resolveAsFile();
+  const SessionReplay replay(captureFile);
+  if (!replay.isValid()) {
+    std::cerr << replay.getError() << std::endl;
+    return 1;
+  }
+
+  std::cout << "Session: " << replay.getNumBlocks() << " blocks, "
+            << replay.getDurationSeconds() << " s at "
+            << replay.getSampleRate() << " Hz, " << replay.getNumChannels()
+            << " channel(s)" << std::endl;
+  if (replay.getNumGaps() > 0) {
+    std::cout << "Warning: the capture dropped blocks in "
+              << replay.getNumGaps() << " place(s)" << std::endl;
+  }
+
+  std::unique_ptr<juce::AudioFormatWriter> writer;
+  if (args.containsOption("--output")) {
+    const auto outputFile = args.getFileForOption("--output");
+    writer = createWavWriter(outputFile, replay.getSampleRate(),
+                             replay.getNumChannels());
+    if (writer == nullptr) {
+      std::cerr << "Could not write " << outputFile.getFullPathName()
+                << std::endl;
+      return 1;
+    }
+  }
+
+  const int iterations = juce::jmax(1, getIntOption(args, "--iterations", 3));
+  std::vector<double> blockNs;
+  blockNs.reserve(static_cast<size_t>(replay.getNumBlocks()));
+  uint64_t firstHash = 0;
+  bool deterministic = true;
+
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    DynamicsAudioProcessor processor;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    double totalNs = 0.0;
+    blockNs.clear();
+
+    replay.run(processor, [&](int, const juce::AudioBuffer<float> &output,
+                              double ns) {
+      hash = hashBlock(hash, output);
+      totalNs += ns;
+      blockNs.push_back(ns);
+      if (iteration == 0 && writer != nullptr) {
+        writer->writeFromAudioSampleBuffer(output, 0, output.getNumSamples());
+      }
+    });
+    processor.releaseResources();
+    writer.reset();
+
+    if (iteration == 0) {
+      firstHash = hash;
+    } else if (hash != firstHash) {
+      deterministic = false;
+    }
+
+    const double seconds = totalNs / 1.0e9;
+    std::cout << "Iteration " << iteration + 1 << ": " << seconds * 1000.0
+              << " ms, "
+              << (seconds > 0.0 ? replay.getDurationSeconds() / seconds : 0.0)
+              << "x real time, block mean "
+              << totalNs / static_cast<double>(blockNs.size()) / 1000.0
+              << " us, p99 " << percentile(blockNs, 0.99) / 1000.0
+              << " us, max " << percentile(blockNs, 1.0) / 1000.0 << " us"
+              << std::endl;
+  }
+
+  if (!deterministic) {
+    std::cout << "FAILED: the output differs between iterations" << std::endl;
+    return 1;
+  }
+  std::cout << "OK" << std::endl;
+  return 0;
+}
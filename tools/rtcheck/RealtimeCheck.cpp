@@ -0,0 +1,165 @@
+// Interposes the glibc allocator and the pthread mutex functions. Every call
+// made by a thread inside a real-time region is reported to stderr together
+// with a stack trace. operator new and delete end up in malloc and free, so
+// they are covered as well. Linux only.
+
+#include "RealtimeCheck.h"
+
+#if !defined(__linux__)
+#error "frogify_rtcheck interposes glibc functions and only supports Linux"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void __libc_free(void *ptr);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+}
+
+namespace rtcheck {
+
+namespace {
+
+thread_local int regionDepth = 0;
+thread_local bool reporting = false;
+std::atomic<uint64_t> numViolations{0};
+std::atomic<bool> abortOnViolation{false};
+
+void report(const char *function) noexcept {
+  if (regionDepth == 0 || reporting) {
+    return;
+  }
+
+  // Reporting may allocate itself, those calls are not reported again
+  reporting = true;
+  numViolations.fetch_add(1);
+
+  char message[160];
+  const int length = std::snprintf(
+      message, sizeof(message),
+      "[rtcheck] %s called inside a real-time region, stack trace:\n",
+      function);
+  if (length > 0) {
+    const auto size = std::min(static_cast<size_t>(length), sizeof(message) - 1);
+    [[maybe_unused]] auto written = ::write(STDERR_FILENO, message, size);
+  }
+
+  void *frames[64];
+  const int numFrames = ::backtrace(frames, 64);
+  ::backtrace_symbols_fd(frames, numFrames, STDERR_FILENO);
+
+  reporting = false;
+  if (abortOnViolation.load()) {
+    std::abort();
+  }
+}
+
+// backtrace() loads libgcc on its first call, which allocates, so it is
+// warmed up before any real-time region can be entered
+struct BacktraceWarmUp {
+  BacktraceWarmUp() {
+    void *frames[4];
+    ::backtrace(frames, 4);
+  }
+} backtraceWarmUp;
+
+template <typename Fn> Fn resolveNext(std::atomic<Fn> &cache, const char *name) {
+  auto fn = cache.load(std::memory_order_acquire);
+  if (fn == nullptr) {
+    fn = reinterpret_cast<Fn>(::dlsym(RTLD_NEXT, name));
+    cache.store(fn, std::memory_order_release);
+  }
+  return fn;
+}
+
+} // namespace
+
+void enterRealtimeRegion() noexcept { ++regionDepth; }
+void leaveRealtimeRegion() noexcept { --regionDepth; }
+uint64_t getNumViolations() noexcept { return numViolations.load(); }
+void setAbortOnViolation(bool shouldAbort) noexcept {
+  abortOnViolation.store(shouldAbort);
+}
+
+} // namespace rtcheck
+
+extern "C" {
+
+void *malloc(size_t size) {
+  rtcheck::report("malloc");
+  return __libc_malloc(size);
+}
+
+void free(void *ptr) {
+  if (ptr != nullptr) {
+    rtcheck::report("free");
+  }
+  __libc_free(ptr);
+}
+
+void *calloc(size_t count, size_t size) {
+  rtcheck::report("calloc");
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  rtcheck::report("realloc");
+  return __libc_realloc(ptr, size);
+}
+
+void *memalign(size_t alignment, size_t size) {
+  rtcheck::report("memalign");
+  return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) {
+  rtcheck::report("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **result, size_t alignment, size_t size) {
+  rtcheck::report("posix_memalign");
+  if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void *ptr = __libc_memalign(alignment, size);
+  if (ptr == nullptr) {
+    return ENOMEM;
+  }
+  *result = ptr;
+  return 0;
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex) {
+  using Fn = int (*)(pthread_mutex_t *);
+  static std::atomic<Fn> next{nullptr};
+  rtcheck::report("pthread_mutex_lock");
+  return rtcheck::resolveNext(next, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t *lock) {
+  using Fn = int (*)(pthread_rwlock_t *);
+  static std::atomic<Fn> next{nullptr};
+  rtcheck::report("pthread_rwlock_rdlock");
+  return rtcheck::resolveNext(next, "pthread_rwlock_rdlock")(lock);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t *lock) {
+  using Fn = int (*)(pthread_rwlock_t *);
+  static std::atomic<Fn> next{nullptr};
+  rtcheck::report("pthread_rwlock_wrlock");
+  return rtcheck::resolveNext(next, "pthread_rwlock_wrlock")(lock);
+}
+
+} // extern "C"
@@ -0,0 +1,136 @@
+// Runs the processor headless with the allocator and mutex functions
+// interposed (see RealtimeCheck.cpp) and exits with a non-zero status if
+// processBlock allocated, freed or locked on the audio thread.
+
+#include "PluginProcessor.h"
+#include "RealtimeCheck.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+struct Scenario {
+  const char *name;
+  bool allBuses;
+  bool morph;
+};
+
+const Scenario scenarios[] = {
+    {"main bus", false, false},
+    {"all stems", true, false},
+    {"morph", false, true},
+    {"morph with stems", true, true},
+};
+
+int getIntOption(const juce::ArgumentList &args, const juce::String &option,
+                 int defaultValue) {
+  if (!args.containsOption(option)) {
+    return defaultValue;
+  }
+  return args.getValueForOption(option).getIntValue();
+}
+
+uint64_t runScenario(const Scenario &scenario, double sampleRate,
+                     int maxBlockSize, int numBlocks) {
+  DynamicsAudioProcessor processor;
+  if (scenario.allBuses) {
+    processor.enableAllBuses();
+  }
+
+  const auto &parameters = processor.getParameters();
+  parameters[Param::Enabled]->setValueNotifyingHost(1.0f);
+  parameters[Param::MorphEnabled]->setValueNotifyingHost(scenario.morph ? 1.0f
+                                                                        : 0.0f);
+
+  processor.prepareToPlay(sampleRate, maxBlockSize);
+
+  const int numChannels = std::max(processor.getTotalNumInputChannels(),
+                                   processor.getTotalNumOutputChannels());
+  juce::AudioBuffer<float> buffer(numChannels, maxBlockSize);
+  juce::MidiBuffer midi;
+  juce::Random random(1234);
+
+  // Automate every parameter except the ones selecting the scenario from a
+  // second thread, like a host would, and keep rewriting the morph slots
+  std::atomic<bool> automating{true};
+  std::thread automation([&processor, &parameters, &automating] {
+    juce::Random automationRandom(42);
+    size_t slot = 0;
+    while (automating.load()) {
+      for (int i = 0; i < parameters.size(); ++i) {
+        if (i != Param::Enabled && i != Param::MorphEnabled) {
+          parameters[i]->setValueNotifyingHost(automationRandom.nextFloat());
+        }
+      }
+      processor.setMorphSnapshot(slot, {automationRandom.nextFloat() * 100.0f,
+                                        automationRandom.nextFloat() * -24.0f});
+      slot = (slot + 1) % MorphEngine::NumSnapshots;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  const auto violationsBefore = rtcheck::getNumViolations();
+  for (int block = 0; block < numBlocks; ++block) {
+    if (block % 64 == 0) {
+      processor.setCurrentProgram((block / 64) % processor.getNumPrograms());
+    }
+
+    // Hosts may call with any block size up to the prepared maximum
+    const int numSamples = random.nextInt({1, maxBlockSize + 1});
+    juce::AudioBuffer<float> view(buffer.getArrayOfWritePointers(),
+                                  numChannels, numSamples);
+    for (int channel = 0; channel < numChannels; ++channel) {
+      auto *samples = view.getWritePointer(channel);
+      for (int i = 0; i < numSamples; ++i) {
+        samples[i] = random.nextFloat() * 2.0f - 1.0f;
+      }
+    }
+
+    processor.processBlock(view, midi);
+  }
+
+  automating.store(false);
+  automation.join();
+  processor.releaseResources();
+  return rtcheck::getNumViolations() - violationsBefore;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  juce::ArgumentList args(argc, argv);
+  if (args.containsOption("--help|-h")) {
+    std::cout << "Usage: frogify_rtcheck [--blocks N] [--block-size N] "
+                 "[--sample-rate N] [--abort]\n";
+    return 0;
+  }
+
+  // The processor owns an APVTS, which needs a message manager
+  juce::ScopedJuceInitialiser_GUI juceInitialiser;
+  // FROGIFY_CAPTURE set for a host session must not record the tool itself
+  SessionCapture::setEnvironmentCaptureAllowed(false);
+
+  const int numBlocks = getIntOption(args, "--blocks", 2000);
+  const int blockSize = getIntOption(args, "--block-size", 512);
+  const double sampleRate = getIntOption(args, "--sample-rate", 48000);
+  rtcheck::setAbortOnViolation(args.containsOption("--abort"));
+
+  uint64_t totalViolations = 0;
+  for (const auto &scenario : scenarios) {
+    const auto violations =
+        runScenario(scenario, sampleRate, blockSize, numBlocks);
+    std::cout << scenario.name << ": " << violations << " violation(s)"
+              << std::endl;
+    totalViolations += violations;
+  }
+
+  if (totalViolations > 0) {
+    std::cout << "FAILED: processBlock is not real-time safe" << std::endl;
+    return 1;
+  }
+  std::cout << "OK" << std::endl;
+  return 0;
+}